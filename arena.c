@@ -0,0 +1,49 @@
+#include "arena.h"
+#include "raylib.h"
+#include <stdio.h>
+
+//one bump allocator shared by everything that needs scratch during a frame
+static unsigned char *arenaBase = NULL;
+static size_t arenaUsed = 0;
+static size_t arenaPeak = 0;
+
+void *FrameAlloc(size_t bytes)
+{
+    if(!arenaBase){arenaBase = MemAlloc(FRAME_ARENA_SIZE);}
+    size_t start = (arenaUsed + FRAME_ARENA_ALIGN - 1) & ~(size_t)(FRAME_ARENA_ALIGN - 1);
+    if(start + bytes > FRAME_ARENA_SIZE)
+    {
+        printf("FrameAlloc: out of frame arena, wanted %zu bytes with %zu used\n", bytes, arenaUsed);
+        return NULL;
+    }
+    arenaUsed = start + bytes;
+    if(arenaUsed > arenaPeak){arenaPeak = arenaUsed;}
+    return arenaBase + start;
+}
+
+size_t FrameArenaMark(void)
+{
+    return arenaUsed;
+}
+
+void FrameArenaRelease(size_t mark)
+{
+    if(mark < arenaUsed){arenaUsed = mark;}
+}
+
+void ResetFrameArena(void)
+{
+    arenaUsed = 0;
+}
+
+void UnloadFrameArena(void)
+{
+    if(arenaBase)
+    {
+        printf("frame arena peak: %zu / %d bytes\n", arenaPeak, FRAME_ARENA_SIZE);
+        MemFree(arenaBase);
+    }
+    arenaBase = NULL;
+    arenaUsed = 0;
+    arenaPeak = 0;
+}
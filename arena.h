@@ -0,0 +1,18 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+//constants
+#define FRAME_ARENA_SIZE (1024 * 1024) //bytes of scratch per frame, allocated on first use
+#define FRAME_ARENA_ALIGN 16
+
+//functions
+//scratch memory that lives until the next ResetFrameArena, returns NULL when the frame is out of space
+void *FrameAlloc(size_t bytes);
+size_t FrameArenaMark(void);
+void FrameArenaRelease(size_t mark); //give back everything allocated since the mark
+void ResetFrameArena(void);
+void UnloadFrameArena(void);
+
+#endif // ARENA_H
@@ -0,0 +1,208 @@
+#include "bone_hitbox.h"
+#include "raylib.h"
+#include "raymath.h"
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+
+static bool IsHeadBoneName(const char *name)
+{
+    char lower[32];
+    int i = 0;
+    for(; i < 31 && name[i]; i++){lower[i] = (char)tolower((unsigned char)name[i]);}
+    lower[i] = '\0';
+    return strstr(lower, "head") != NULL;
+}
+
+//bind pose bone space, the skinning in UpdateModelAnimation takes vertices through this before the frame pose
+static Vector3 ToBoneSpace(Transform bind, Vector3 v)
+{
+    return Vector3RotateByQuaternion(Vector3Subtract(v, bind.translation), QuaternionInvert(bind.rotation));
+}
+
+BoneHitSet BuildBoneHitSet(Model model)
+{
+    BoneHitSet set = {0};
+    if(model.boneCount <= 0 || model.bindPose == NULL){return set;}
+
+    set.boneCount = model.boneCount < BONE_HITBOX_MAX_BONES ? model.boneCount : BONE_HITBOX_MAX_BONES;
+    set.bones = MemAlloc(sizeof(BoneHitBox) * set.boneCount);
+    set.bindPose = MemAlloc(sizeof(Transform) * set.boneCount);
+    memcpy(set.bindPose, model.bindPose, sizeof(Transform) * set.boneCount);
+    set.transform = model.transform;
+
+    //every vertex grows the box of the bone with the biggest weight on it
+    for(int m = 0; m < model.meshCount; m++)
+    {
+        Mesh mesh = model.meshes[m];
+        if(mesh.boneIds == NULL || mesh.boneWeights == NULL){continue;}
+        for(int v = 0; v < mesh.vertexCount; v++)
+        {
+            int best = 0;
+            for(int j = 1; j < 4; j++)
+            {
+                if(mesh.boneWeights[v * 4 + j] > mesh.boneWeights[v * 4 + best]){best = j;}
+            }
+            int b = mesh.boneIds[v * 4 + best];
+            if(b >= set.boneCount || mesh.boneWeights[v * 4 + best] <= 0.0f){continue;}
+            Vector3 p = ToBoneSpace(set.bindPose[b], (Vector3){ mesh.vertices[v * 3], mesh.vertices[v * 3 + 1], mesh.vertices[v * 3 + 2] });
+            BoneHitBox *hb = &set.bones[b];
+            if(!hb->used){hb->local = (BoundingBox){ p, p }; hb->used = true;}
+            hb->local.min = Vector3Min(hb->local.min, p);
+            hb->local.max = Vector3Max(hb->local.max, p);
+        }
+    }
+
+    //head bones by name, children follow their parent so jaws and helmets count too
+    int headCount = 0;
+    int usedCount = 0;
+    for(int b = 0; b < set.boneCount; b++)
+    {
+        set.bones[b].local.min = Vector3SubtractValue(set.bones[b].local.min, BONE_HITBOX_PAD);
+        set.bones[b].local.max = Vector3AddValue(set.bones[b].local.max, BONE_HITBOX_PAD);
+        int parent = model.bones[b].parent;
+        set.bones[b].head = IsHeadBoneName(model.bones[b].name) || (parent >= 0 && parent < b && set.bones[parent].head);
+        if(set.bones[b].used){usedCount++;}
+        if(set.bones[b].used && set.bones[b].head){headCount++;}
+    }
+    //no bone called head, the topmost bone box in the bind pose is the head
+    if(headCount == 0)
+    {
+        int top = -1;
+        float topY = -INFINITY;
+        for(int b = 0; b < set.boneCount; b++)
+        {
+            if(!set.bones[b].used){continue;}
+            float y = set.bindPose[b].translation.y;
+            if(y > topY){topY = y; top = b;}
+        }
+        if(top >= 0){set.bones[top].head = true; headCount = 1;}
+    }
+    printf("bone hitboxes: %d of %d bones, %d head\n", usedCount, model.boneCount, headCount);
+    return set;
+}
+
+void UnloadBoneHitSet(BoneHitSet *set)
+{
+    if(set->bones){MemFree(set->bones);}
+    if(set->bindPose){MemFree(set->bindPose);}
+    *set = (BoneHitSet){0};
+}
+
+//turns the local box axis k into a world direction scaled by its half extent, rigid and scaled matrices both work
+static Vector3 TransformDir(Matrix m, Vector3 d)
+{
+    return (Vector3){ m.m0 * d.x + m.m4 * d.y + m.m8 * d.z, m.m1 * d.x + m.m5 * d.y + m.m9 * d.z, m.m2 * d.x + m.m6 * d.y + m.m10 * d.z };
+}
+
+//world boxes of every used bone for one animation frame, anim NULL or frame < 0 is the bind pose
+//returns how many boxes went to out, which must hold BONE_HITBOX_MAX_BONES
+int PoseBoneHitBoxes(const BoneHitSet *set, const ModelAnimation *anim, int frame, Vector3 pos, float yaw, BoneObb *out)
+{
+    if(anim != NULL && (anim->boneCount < set->boneCount || anim->frameCount <= 0)){anim = NULL;}
+    if(anim != NULL && frame >= anim->frameCount){frame = anim->frameCount - 1;}
+    Matrix world = MatrixMultiply(set->transform, MatrixMultiply(MatrixRotateY(yaw), MatrixTranslate(pos.x, pos.y, pos.z)));
+    int count = 0;
+    for(int b = 0; b < set->boneCount; b++)
+    {
+        const BoneHitBox *hb = &set->bones[b];
+        if(!hb->used){continue;}
+        Transform pose = (anim != NULL && frame >= 0) ? anim->framePoses[frame][b] : set->bindPose[b];
+        float scale = fmaxf(pose.scale.x, fmaxf(pose.scale.y, pose.scale.z));
+        Vector3 localCenter = Vector3Scale(Vector3Add(hb->local.min, hb->local.max), 0.5f);
+        Vector3 localHalf = Vector3Scale(Vector3Subtract(hb->local.max, hb->local.min), 0.5f);
+        //frame pose, same order as the skinning: scale, rotate, translate
+        Vector3 center = Vector3Add(pose.translation, Vector3RotateByQuaternion(Vector3Scale(localCenter, scale), pose.rotation));
+        BoneObb *o = &out[count++];
+        o->center = Vector3Transform(center, world);
+        const float *half = &localHalf.x;
+        float *outHalf = &o->half.x;
+        Vector3 unit[3] = { {1, 0, 0}, {0, 1, 0}, {0, 0, 1} };
+        for(int k = 0; k < 3; k++)
+        {
+            Vector3 d = TransformDir(world, Vector3RotateByQuaternion(Vector3Scale(unit[k], half[k] * scale), pose.rotation));
+            outHalf[k] = Vector3Length(d);
+            o->axis[k] = outHalf[k] > 0.0f ? Vector3Scale(d, 1.0f / outHalf[k]) : unit[k];
+        }
+        o->radius = Vector3Length(o->half);
+        o->bone = b;
+        o->head = hb->head;
+    }
+    return count;
+}
+
+//world aabb around posed bone boxes
+BoundingBox GetBoneHitBounds(const BoneObb *obbs, int count)
+{
+    if(count <= 0){return (BoundingBox){0};}
+    BoundingBox box = { obbs[0].center, obbs[0].center };
+    for(int i = 0; i < count; i++)
+    {
+        const BoneObb *o = &obbs[i];
+        Vector3 e = {
+            fabsf(o->axis[0].x) * o->half.x + fabsf(o->axis[1].x) * o->half.y + fabsf(o->axis[2].x) * o->half.z,
+            fabsf(o->axis[0].y) * o->half.x + fabsf(o->axis[1].y) * o->half.y + fabsf(o->axis[2].y) * o->half.z,
+            fabsf(o->axis[0].z) * o->half.x + fabsf(o->axis[1].z) * o->half.y + fabsf(o->axis[2].z) * o->half.z
+        };
+        box.min = Vector3Min(box.min, Vector3Subtract(o->center, e));
+        box.max = Vector3Max(box.max, Vector3Add(o->center, e));
+    }
+    return box;
+}
+
+//model space bounds of one pose, no yaw or position, for a cheap reject box that follows the animation
+BoundingBox GetBonePoseBounds(const BoneHitSet *set, const ModelAnimation *anim, int frame)
+{
+    BoneObb obbs[BONE_HITBOX_MAX_BONES];
+    int count = PoseBoneHitBoxes(set, anim, frame, (Vector3){0}, 0.0f, obbs);
+    return GetBoneHitBounds(obbs, count);
+}
+
+//slab test in the box's own axes, entry distance goes negative when the ray starts inside
+static bool RayObbEntry(Ray ray, const BoneObb *o, float *tEnter)
+{
+    Vector3 d = Vector3Subtract(o->center, ray.position);
+    const float *half = &o->half.x;
+    float tMin = -INFINITY;
+    float tMax = INFINITY;
+    for(int k = 0; k < 3; k++)
+    {
+        float e = Vector3DotProduct(o->axis[k], d);
+        float f = Vector3DotProduct(o->axis[k], ray.direction);
+        if(fabsf(f) < 1e-6f)
+        {
+            if(fabsf(e) > half[k]){return false;}
+            continue;
+        }
+        float t0 = (e - half[k]) / f;
+        float t1 = (e + half[k]) / f;
+        tMin = fmaxf(tMin, fminf(t0, t1));
+        tMax = fminf(tMax, fmaxf(t0, t1));
+        if(tMin > tMax || tMax < 0.0f){return false;}
+    }
+    *tEnter = tMin;
+    return true;
+}
+
+//closest posed bone box along the ray nearer than maxDist, returns its index in obbs or -1
+//bones whose bounding sphere the ray passes by are skipped before the box test
+int GetRayCollisionBoneHitBoxes(Ray ray, const BoneObb *obbs, int count, float maxDist, float *outDist)
+{
+    int best = -1;
+    float bestDist = maxDist;
+    for(int i = 0; i < count; i++)
+    {
+        const BoneObb *o = &obbs[i];
+        Vector3 w = Vector3Subtract(o->center, ray.position);
+        float along = Vector3DotProduct(w, ray.direction);
+        if(along < -o->radius || along - o->radius >= bestDist){continue;}
+        if(Vector3DotProduct(w, w) - along * along > o->radius * o->radius){continue;}
+        float t;
+        if(!RayObbEntry(ray, o, &t) || t >= bestDist){continue;}
+        best = i;
+        bestDist = t;
+    }
+    if(best >= 0){*outDist = bestDist;}
+    return best;
+}
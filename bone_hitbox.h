@@ -0,0 +1,44 @@
+#ifndef BONE_HITBOX_H
+#define BONE_HITBOX_H
+
+#include "raylib.h"
+
+//constants
+#define BONE_HITBOX_MAX_BONES 128 //bones past this get no hitbox
+#define BONE_HITBOX_PAD 0.02f //meters added around the skin of every bone box
+
+//structs
+//box around the vertices one bone drives most, in that bone's bind pose space
+typedef struct {
+    BoundingBox local;
+    bool used; //false when no vertex follows this bone, it gets no hitbox
+    bool head; //named head, or a child of the head bone
+} BoneHitBox;
+
+//hitboxes for every bone of one skinned model, shared by every enemy using that model
+typedef struct {
+    BoneHitBox *bones;
+    int boneCount;
+    Transform *bindPose; //copy of the model bind pose
+    Matrix transform; //model.transform, applied before the enemy yaw and position like DrawModelEx does
+} BoneHitSet;
+
+//one posed bone box in world space
+typedef struct {
+    Vector3 center;
+    Vector3 axis[3]; //unit axes
+    Vector3 half; //half extent along each axis
+    float radius; //bounding sphere, rays further than this from center skip the box test
+    int bone;
+    bool head;
+} BoneObb;
+
+//functions
+BoneHitSet BuildBoneHitSet(Model model);
+void UnloadBoneHitSet(BoneHitSet *set);
+int PoseBoneHitBoxes(const BoneHitSet *set, const ModelAnimation *anim, int frame, Vector3 pos, float yaw, BoneObb *out);
+BoundingBox GetBoneHitBounds(const BoneObb *obbs, int count);
+BoundingBox GetBonePoseBounds(const BoneHitSet *set, const ModelAnimation *anim, int frame);
+int GetRayCollisionBoneHitBoxes(Ray ray, const BoneObb *obbs, int count, float maxDist, float *outDist);
+
+#endif // BONE_HITBOX_H
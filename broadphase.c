@@ -0,0 +1,137 @@
+#include "broadphase.h"
+#include "raylib.h"
+#include "raymath.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+static int ClampInt(int v, int lo, int hi)
+{
+    if(v < lo){return lo;}
+    if(v > hi){return hi;}
+    return v;
+}
+
+static int CellX(const WorldGrid *g, float x)
+{
+    return ClampInt((int)floorf((x - g->minX) / g->cellSize), 0, g->cols - 1);
+}
+
+static int CellZ(const WorldGrid *g, float z)
+{
+    return ClampInt((int)floorf((z - g->minZ) / g->cellSize), 0, g->rows - 1);
+}
+
+static int CompareInts(const void *a, const void *b)
+{
+    return *(const int*)a - *(const int*)b;
+}
+
+WorldGrid BuildWorldGrid(const BoundingBox *boxes, int count, float cellSize)
+{
+    WorldGrid g = {0};
+    if(count <= 0){return g;}
+
+    //grid bounds are the bounds of everything in it
+    float minX = boxes[0].min.x, maxX = boxes[0].max.x;
+    float minZ = boxes[0].min.z, maxZ = boxes[0].max.z;
+    for(int i = 1; i < count; i++)
+    {
+        minX = fminf(minX, boxes[i].min.x); maxX = fmaxf(maxX, boxes[i].max.x);
+        minZ = fminf(minZ, boxes[i].min.z); maxZ = fmaxf(maxZ, boxes[i].max.z);
+    }
+    g.minX = minX;
+    g.minZ = minZ;
+    g.cellSize = cellSize;
+    g.cols = (int)ceilf((maxX - minX) / g.cellSize) + 1;
+    g.rows = (int)ceilf((maxZ - minZ) / g.cellSize) + 1;
+    while(g.cols * g.rows > WORLD_GRID_MAX_CELLS)
+    {
+        g.cellSize *= 2.0f;
+        g.cols = (int)ceilf((maxX - minX) / g.cellSize) + 1;
+        g.rows = (int)ceilf((maxZ - minZ) / g.cellSize) + 1;
+    }
+    int cellCount = g.cols * g.rows;
+
+    //count pass, then fill pass into the compressed rows
+    g.cellStart = MemAlloc(sizeof(int) * (cellCount + 1));
+    for(int i = 0; i < count; i++)
+    {
+        int x0 = CellX(&g, boxes[i].min.x), x1 = CellX(&g, boxes[i].max.x);
+        int z0 = CellZ(&g, boxes[i].min.z), z1 = CellZ(&g, boxes[i].max.z);
+        for(int z = z0; z <= z1; z++)
+        {
+            for(int x = x0; x <= x1; x++){g.cellStart[z * g.cols + x + 1]++;}
+        }
+    }
+    for(int c = 0; c < cellCount; c++){g.cellStart[c + 1] += g.cellStart[c];}
+
+    g.cellItems = MemAlloc(sizeof(int) * (g.cellStart[cellCount] > 0 ? g.cellStart[cellCount] : 1));
+    int *fill = MemAlloc(sizeof(int) * cellCount);
+    for(int i = 0; i < count; i++)
+    {
+        int x0 = CellX(&g, boxes[i].min.x), x1 = CellX(&g, boxes[i].max.x);
+        int z0 = CellZ(&g, boxes[i].min.z), z1 = CellZ(&g, boxes[i].max.z);
+        for(int z = z0; z <= z1; z++)
+        {
+            for(int x = x0; x <= x1; x++)
+            {
+                int c = z * g.cols + x;
+                g.cellItems[g.cellStart[c] + fill[c]++] = i;
+            }
+        }
+    }
+    MemFree(fill);
+
+    g.itemCount = count;
+    g.boxes = MemAlloc(sizeof(BoundingBox) * count);
+    memcpy(g.boxes, boxes, sizeof(BoundingBox) * count);
+    g.stamp = MemAlloc(sizeof(int) * count);
+    g.stampId = 0;
+    printf("world grid: %dx%d cells of %.1fm, %d entries\n", g.cols, g.rows, g.cellSize, g.cellStart[cellCount]);
+    return g;
+}
+
+//writes every item whose box overlaps box into out in ascending index order, returns how many
+int QueryWorldGrid(WorldGrid *g, BoundingBox box, int *out, int maxOut)
+{
+    if(g->itemCount == 0){return 0;}
+
+    g->stampId++;
+    if(g->stampId == 0) //wrapped, old stamps could collide with new ids
+    {
+        memset(g->stamp, 0, sizeof(int) * g->itemCount);
+        g->stampId = 1;
+    }
+
+    int found = 0;
+    int x0 = CellX(g, box.min.x), x1 = CellX(g, box.max.x);
+    int z0 = CellZ(g, box.min.z), z1 = CellZ(g, box.max.z);
+    for(int z = z0; z <= z1; z++)
+    {
+        for(int x = x0; x <= x1; x++)
+        {
+            int c = z * g->cols + x;
+            for(int k = g->cellStart[c]; k < g->cellStart[c + 1]; k++)
+            {
+                int item = g->cellItems[k];
+                if(g->stamp[item] == g->stampId){continue;}
+                g->stamp[item] = g->stampId;
+                if(found < maxOut && CheckCollisionBoxes(g->boxes[item], box)){out[found++] = item;}
+            }
+        }
+    }
+    //callers resolve collisions in level order, keep it that way
+    qsort(out, found, sizeof(int), CompareInts);
+    return found;
+}
+
+void UnloadWorldGrid(WorldGrid *g)
+{
+    if(g->cellStart){MemFree(g->cellStart);}
+    if(g->cellItems){MemFree(g->cellItems);}
+    if(g->boxes){MemFree(g->boxes);}
+    if(g->stamp){MemFree(g->stamp);}
+    *g = (WorldGrid){0};
+}
@@ -0,0 +1,31 @@
+#ifndef BROADPHASE_H
+#define BROADPHASE_H
+
+#include "raylib.h"
+
+//constants for the world grid
+#define WORLD_GRID_CELL_SIZE 8.0f //meters, a few player widths, default for the env object grid
+#define WORLD_GRID_MAX_CELLS 65536 //cell size grows if a huge map would go past this
+
+//structs
+//uniform grid over x/z, every cell lists the objects whose box touches it (compressed rows, cellStart[c]..cellStart[c+1])
+typedef struct {
+    float minX;
+    float minZ;
+    float cellSize;
+    int cols;
+    int rows;
+    int *cellStart;
+    int *cellItems;
+    int itemCount;
+    BoundingBox *boxes; //per item, copy of the box it was inserted with
+    int *stamp; //per item, last query that returned it, so items spanning many cells come back once
+    int stampId;
+} WorldGrid;
+
+//functions
+WorldGrid BuildWorldGrid(const BoundingBox *boxes, int count, float cellSize);
+int QueryWorldGrid(WorldGrid *g, BoundingBox box, int *out, int maxOut);
+void UnloadWorldGrid(WorldGrid *g);
+
+#endif // BROADPHASE_H
@@ -0,0 +1,67 @@
+#include "brush.h"
+#include "raylib.h"
+#include "raymath.h"
+#include <stdio.h>
+#include <math.h>
+
+bool CheckPointInBrush(const BrushPlane *planes, int planeCount, Vector3 p)
+{
+    if(planeCount <= 0){return false;}
+    for(int i = 0; i < planeCount; i++)
+    {
+        if(Vector3DotProduct(planes[i].normal, p) > planes[i].d + BRUSH_PLANE_EPSILON){return false;}
+    }
+    return true;
+}
+
+//every plane is pushed out by the box extents along its normal, then the box center is tested against it
+//only the face axes are tested, so near brush edges this can say touching when the box is just outside,
+//callers check the box against the brush bounds first which covers the box axes
+bool CheckCollisionBrushAABB(const BrushPlane *planes, int planeCount, BoundingBox box)
+{
+    if(planeCount <= 0){return false;}
+    Vector3 c = Vector3Scale(Vector3Add(box.min, box.max), 0.5f);
+    Vector3 e = Vector3Scale(Vector3Subtract(box.max, box.min), 0.5f);
+    for(int i = 0; i < planeCount; i++)
+    {
+        Vector3 n = planes[i].normal;
+        float r = fabsf(n.x) * e.x + fabsf(n.y) * e.y + fabsf(n.z) * e.z;
+        if(Vector3DotProduct(n, c) - r > planes[i].d + BRUSH_PLANE_EPSILON){return false;}
+    }
+    return true;
+}
+
+//slab test against the planes, same result layout as GetRayCollisionBox
+//a ray starting inside the brush hits at distance 0
+RayCollision GetRayCollisionBrush(Ray ray, const BrushPlane *planes, int planeCount)
+{
+    RayCollision coll = {0};
+    if(planeCount <= 0){return coll;}
+
+    float tEnter = 0.0f;
+    float tExit = INFINITY;
+    Vector3 enterNormal = Vector3Negate(ray.direction);
+    for(int i = 0; i < planeCount; i++)
+    {
+        float denom = Vector3DotProduct(planes[i].normal, ray.direction);
+        float dist = planes[i].d - Vector3DotProduct(planes[i].normal, ray.position);
+        if(fabsf(denom) < 1e-8f)
+        {
+            if(dist < -BRUSH_PLANE_EPSILON){return coll;} //parallel and outside this plane
+            continue;
+        }
+        float t = dist / denom;
+        if(denom < 0.0f) //heading into the plane
+        {
+            if(t > tEnter){tEnter = t; enterNormal = planes[i].normal;}
+        }
+        else if(t < tExit){tExit = t;}
+        if(tEnter > tExit){return coll;}
+    }
+
+    coll.hit = true;
+    coll.distance = tEnter;
+    coll.point = Vector3Add(ray.position, Vector3Scale(ray.direction, tEnter));
+    coll.normal = enterNormal;
+    return coll;
+}
@@ -0,0 +1,22 @@
+#ifndef BRUSH_H
+#define BRUSH_H
+
+#include "raylib.h"
+
+//constants
+#define BRUSH_PLANE_EPSILON 0.0001f //meters, how far outside a plane still counts as touching
+
+//structs
+//one face plane of a convex brush in raylib space (meters, y up), normal points out of the brush
+//a point p is inside the brush when dot(normal, p) <= d for every plane
+typedef struct {
+    Vector3 normal;
+    float d;
+} BrushPlane;
+
+//functions
+bool CheckPointInBrush(const BrushPlane *planes, int planeCount, Vector3 p);
+bool CheckCollisionBrushAABB(const BrushPlane *planes, int planeCount, BoundingBox box);
+RayCollision GetRayCollisionBrush(Ray ray, const BrushPlane *planes, int planeCount);
+
+#endif // BRUSH_H
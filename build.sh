@@ -1,3 +1,3 @@
 #!/bin/bash
 
-gcc main.c level.c map_parser.c collision.c game.c functions.c timer.c -o game -lraylib -lGL -lm -lpthread -ldl -lrt -lX11
+gcc main.c level.c map_parser.c collision.c game.c functions.c timer.c bvh.c collision_mesh.c broadphase.c brush.c ground_field.c arena.c collision_stats.c raycast.c los.c pvs.c bone_hitbox.c static_batch.c instancing.c skin_cache.c job_pool.c mesh_lod.c occlusion.c wireframe.c render_queue.c headless.c -o game -lraylib -lGL -lm -lpthread -ldl -lrt -lX11
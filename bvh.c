@@ -0,0 +1,155 @@
+#include "bvh.h"
+#include "raylib.h"
+#include "raymath.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+//qsort has no context pointer, so the centroids and split axis for the current sort live here
+static const Vector3 *sortCentroids = NULL;
+static int sortAxis = 0;
+
+static float AxisValue(Vector3 v, int axis)
+{
+    if(axis == 0){return v.x;}
+    if(axis == 1){return v.y;}
+    return v.z;
+}
+
+static int CompareCentroids(const void *a, const void *b)
+{
+    float ca = AxisValue(sortCentroids[*(const int*)a], sortAxis);
+    float cb = AxisValue(sortCentroids[*(const int*)b], sortAxis);
+    if(ca < cb){return -1;}
+    if(ca > cb){return 1;}
+    return 0;
+}
+
+static BoundingBox MergeBoxes(BoundingBox a, BoundingBox b)
+{
+    return (BoundingBox){ Vector3Min(a.min, b.min), Vector3Max(a.max, b.max) };
+}
+
+//builds the node for prims[first .. first+count) and returns its index, children are built depth first
+static int BuildNode(Bvh *bvh, const BoundingBox *boxes, const Vector3 *centroids, int first, int count)
+{
+    int nodeIndex = bvh->nodeCount++;
+
+    BoundingBox box = boxes[bvh->prims[first]];
+    Vector3 cMin = centroids[bvh->prims[first]];
+    Vector3 cMax = cMin;
+    for(int i = 1; i < count; i++)
+    {
+        int p = bvh->prims[first + i];
+        box = MergeBoxes(box, boxes[p]);
+        cMin = Vector3Min(cMin, centroids[p]);
+        cMax = Vector3Max(cMax, centroids[p]);
+    }
+    bvh->nodes[nodeIndex].box = box;
+
+    if(count <= BVH_LEAF_SIZE)
+    {
+        bvh->nodes[nodeIndex].left = -1;
+        bvh->nodes[nodeIndex].right = -1;
+        bvh->nodes[nodeIndex].first = first;
+        bvh->nodes[nodeIndex].count = count;
+        return nodeIndex;
+    }
+
+    //median split along the longest axis of the centroid bounds
+    Vector3 extent = Vector3Subtract(cMax, cMin);
+    sortAxis = 0;
+    if(extent.y > extent.x){sortAxis = 1;}
+    if(extent.z > AxisValue(extent, sortAxis)){sortAxis = 2;}
+    sortCentroids = centroids;
+    qsort(&bvh->prims[first], count, sizeof(int), CompareCentroids);
+
+    int half = count / 2;
+    int left = BuildNode(bvh, boxes, centroids, first, half);
+    int right = BuildNode(bvh, boxes, centroids, first + half, count - half);
+    bvh->nodes[nodeIndex].left = left;
+    bvh->nodes[nodeIndex].right = right;
+    bvh->nodes[nodeIndex].first = first;
+    bvh->nodes[nodeIndex].count = count;
+    return nodeIndex;
+}
+
+Bvh BuildBvh(const BoundingBox *boxes, int count)
+{
+    Bvh bvh = {0};
+    if(count <= 0){return bvh;}
+
+    bvh.primCount = count;
+    bvh.prims = MemAlloc(sizeof(int) * count);
+    bvh.nodes = MemAlloc(sizeof(BvhNode) * (2 * count - 1)); //worst case for a binary tree with count leaves
+    Vector3 *centroids = MemAlloc(sizeof(Vector3) * count);
+    for(int i = 0; i < count; i++)
+    {
+        bvh.prims[i] = i;
+        centroids[i] = Vector3Scale(Vector3Add(boxes[i].min, boxes[i].max), 0.5f);
+    }
+
+    BuildNode(&bvh, boxes, centroids, 0, count);
+    MemFree(centroids);
+    return bvh;
+}
+
+//writes the primitives of every leaf overlapping box into out, returns how many were written
+int QueryBvh(const Bvh *bvh, BoundingBox box, int *out, int maxOut)
+{
+    if(bvh->nodeCount == 0){return 0;}
+
+    int stack[BVH_STACK_SIZE];
+    int top = 0;
+    int found = 0;
+    stack[top++] = 0;
+    while(top > 0)
+    {
+        const BvhNode *node = &bvh->nodes[stack[--top]];
+        if(!CheckCollisionBoxes(node->box, box)){continue;}
+        if(node->left < 0)
+        {
+            for(int i = 0; i < node->count && found < maxOut; i++)
+            {
+                out[found++] = bvh->prims[node->first + i];
+            }
+            continue;
+        }
+        stack[top++] = node->left;
+        stack[top++] = node->right;
+    }
+    return found;
+}
+
+//same walk as QueryBvh, but writes the overlapping leaf node indices instead of their primitives
+int QueryBvhLeaves(const Bvh *bvh, BoundingBox box, int *outNodes, int maxOut)
+{
+    if(bvh->nodeCount == 0){return 0;}
+
+    int stack[BVH_STACK_SIZE];
+    int top = 0;
+    int found = 0;
+    stack[top++] = 0;
+    while(top > 0 && found < maxOut)
+    {
+        int nodeIndex = stack[--top];
+        const BvhNode *node = &bvh->nodes[nodeIndex];
+        if(!CheckCollisionBoxes(node->box, box)){continue;}
+        if(node->left < 0)
+        {
+            outNodes[found++] = nodeIndex;
+            continue;
+        }
+        stack[top++] = node->left;
+        stack[top++] = node->right;
+    }
+    return found;
+}
+
+void UnloadBvh(Bvh *bvh)
+{
+    if(bvh->nodes){MemFree(bvh->nodes);}
+    if(bvh->prims){MemFree(bvh->prims);}
+    *bvh = (Bvh){0};
+}
@@ -0,0 +1,33 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include "raylib.h"
+
+//constants for bvh build
+#define BVH_LEAF_SIZE 4 //max primitives in a leaf
+#define BVH_STACK_SIZE 64 //traversal stack, plenty for a median split tree
+
+//structs
+typedef struct {
+    BoundingBox box;
+    int left; //child node index, -1 when this is a leaf
+    int right;
+    int first; //leaf only, first slot in prims
+    int count; //leaf only, number of prims in the leaf
+} BvhNode;
+
+//bounding volume hierarchy over a list of primitive boxes, node 0 is the root
+typedef struct {
+    BvhNode *nodes;
+    int nodeCount;
+    int *prims; //primitive indices, every leaf owns a contiguous run of these
+    int primCount;
+} Bvh;
+
+//functions
+Bvh BuildBvh(const BoundingBox *boxes, int count);
+int QueryBvh(const Bvh *bvh, BoundingBox box, int *out, int maxOut);
+int QueryBvhLeaves(const Bvh *bvh, BoundingBox box, int *outNodes, int maxOut);
+void UnloadBvh(Bvh *bvh);
+
+#endif // BVH_H
@@ -5,6 +5,9 @@
 #include "game.h"
 #include "functions.h"
 #include "collision.h"
+#include "arena.h"
+#include "collision_stats.h"
+#include "los.h"
 #include <stdio.h>
 #include <stdlib.h> 
 #include <math.h>
@@ -163,20 +166,121 @@ float GetRollFromRight(Vector3 right) {
     return -asinf(right.y); // Negative for right side down = positive roll
 }
 
-static Vector3 GetCenterForTriangle(Vector3 v0, Vector3 v1, Vector3 v2)
+//a triangle the contacts have no room for, it is still resolved on its own
+static void SpillContact(ContactManifold *m, CollisionType type, const CollisionTri *tri)
 {
-    Vector3 center = {
-        (v0.x + v1.x + v2.x) / 3.0f,
-        (v0.y + v1.y + v2.y) / 3.0f,
-        (v0.z + v1.z + v2.z) / 3.0f
-    };
-    return center;
+    m->dropped++;
+    if (m->spillCount >= m->spillCapacity) {m->lost++; return;}
+    m->spill[m->spillCount] = tri;
+    m->spillType[m->spillCount++] = type;
+}
+
+//adds a side contact, triangles on the plane of a contact that is already there get folded into it
+static void AddContact(ContactManifold *m, CollisionType type, const CollisionTri *tri)
+{
+    for (int i = 0; i < m->count; i++) {
+        Contact *c = &m->contacts[i];
+        if (c->type != type) continue;
+        if (Vector3DotProduct(c->normal, tri->normal) < CONTACT_COPLANAR_DOT) continue;
+        if (fabsf(c->planeD - tri->planeD) > CONTACT_COPLANAR_DIST) continue;
+        if (c->triCount < CONTACT_MAX_TRIS) {c->tris[c->triCount++] = tri;}
+        else {SpillContact(m, type, tri);}
+        return;
+    }
+    if (m->count >= MAX_CONTACTS) {SpillContact(m, type, tri); return;}
+    Contact *c = &m->contacts[m->count++];
+    c->type = type;
+    c->normal = tri->normal;
+    c->planeD = tri->planeD;
+    c->tris[0] = tri;
+    c->triCount = 1;
+}
+
+static bool ContactsTouchBox(Contact **contacts, int count, const CollisionTri **spill, int spillCount, BoundingBox box, int *satTests)
+{
+    for (int i = 0; i < count; i++) {
+        for (int t = 0; t < contacts[i]->triCount; t++) {
+            (*satTests)++;
+            if (CheckCollisionTriAABB(contacts[i]->tris[t], box)) return true;
+        }
+    }
+    for (int i = 0; i < spillCount; i++) {
+        (*satTests)++;
+        if (CheckCollisionTriAABB(spill[i], box)) return true;
+    }
+    return false;
+}
+
+//slides the move along every pushing wall at once, then checks the result against all of them in one go
+//spilled triangles are walls like any other, one plane each
+//tests and passes go to the caller's counters, flushed once per object
+static void ResolveSideContacts(MainCharacter* mc, Contact **active, int activeCount, const CollisionTri **spill, int spillCount, int *satTests, int *resolvePasses)
+{
+    Vector3 movement = Vector3Subtract(mc->pos, mc->oldPos);
+    Vector3 slide = movement;
+    //clip against each wall, a corner needs a second pass so the first clip does not push back into the other wall
+    for (int iter = 0; iter < CONTACT_SOLVER_ITERATIONS; iter++) {
+        (*resolvePasses)++;
+        bool clipped = false;
+        for (int i = 0; i < activeCount; i++) {
+            float into = Vector3DotProduct(slide, active[i]->normal);
+            if (into < 0.0f) {
+                slide = Vector3Subtract(slide, Vector3Scale(active[i]->normal, into));
+                clipped = true;
+            }
+        }
+        for (int i = 0; i < spillCount; i++) {
+            float into = Vector3DotProduct(slide, spill[i]->normal);
+            if (into < 0.0f) {
+                slide = Vector3Subtract(slide, Vector3Scale(spill[i]->normal, into));
+                clipped = true;
+            }
+        }
+        if (!clipped) break;
+    }
+    Vector3 candidatePos = Vector3Add(mc->oldPos, slide);
+
+    BoundingBox testBox = mc->box;
+    Vector3 offset = Vector3Subtract(candidatePos, mc->pos);
+    testBox.min = Vector3Add(testBox.min, offset);
+    testBox.max = Vector3Add(testBox.max, offset);
+
+    if (!ContactsTouchBox(active, activeCount, spill, spillCount, testBox, satTests)) {
+        mc->pos.x = candidatePos.x;
+        mc->pos.z = candidatePos.z;
+        //printf("Slide Accepted\n");// Slide accepted
+        return;
+    }
+
+    // Push out slightly along the walls to avoid getting stuck
+    const float pushOutDist = 0.01f; // tweak if needed
+    Vector3 wallNormal = {0};
+    for (int i = 0; i < activeCount; i++) wallNormal = Vector3Add(wallNormal, active[i]->normal);
+    for (int i = 0; i < spillCount; i++) wallNormal = Vector3Add(wallNormal, spill[i]->normal);
+    wallNormal = Vector3Normalize(wallNormal);
+    Vector3 tryPos = Vector3Add(mc->oldPos, Vector3Scale(wallNormal, pushOutDist));
+
+    BoundingBox testBox2 = mc->box;
+    Vector3 offset2 = Vector3Subtract(tryPos, mc->pos);
+    testBox2.min = Vector3Add(testBox2.min, offset2);
+    testBox2.max = Vector3Add(testBox2.max, offset2);
+
+    if (!ContactsTouchBox(active, activeCount, spill, spillCount, testBox2, satTests) || Vector3DotProduct(movement, wallNormal) > 0.0f) {
+        // clear, or moving away from the walls, accept the push-out
+        mc->pos.x = tryPos.x;
+        mc->pos.z = tryPos.z;
+        //printf("Wall push-out applied\n");
+    } else {
+        // Moving into wall revert
+        mc->pos.x = mc->oldPos.x;
+        mc->pos.z = mc->oldPos.z;
+        //printf("Slide + push-out blocked, moving into wall\n");
+    }
 }
 
 void HandleObjectCollision(MainCharacter* mc, EnvObject* obj)
 {
-    int triangleCount = obj->model.meshes[0].triangleCount;
-    float *vertices = obj->model.meshes[0].vertices;
+    const CollisionMesh *cm = &obj->colMesh;
 
     mc->isOnPlatform = false;
     bool foundGround = false;
@@ -184,73 +288,84 @@ void HandleObjectCollision(MainCharacter* mc, EnvObject* obj)
     float wallY = 0.0f;
     bool hitCeiling = false;
     bool hitSide = false;
-    Collision colls[triangleCount];
-    int collCount = 0;
-    float maxObjectHeight = -INFINITY;
-    float minObjectHeight = INFINITY;
-
-    for (int i = 0; i < triangleCount; i++) {
-        Vector3 v0 = {
-            vertices[(i * 3 + 0) * 3 + 0],
-            vertices[(i * 3 + 0) * 3 + 1],
-            vertices[(i * 3 + 0) * 3 + 2]
-        };
-        Vector3 v1 = {
-            vertices[(i * 3 + 1) * 3 + 0],
-            vertices[(i * 3 + 1) * 3 + 1],
-            vertices[(i * 3 + 1) * 3 + 2]
-        };
-        Vector3 v2 = {
-            vertices[(i * 3 + 2) * 3 + 0],
-            vertices[(i * 3 + 2) * 3 + 1],
-            vertices[(i * 3 + 2) * 3 + 2]
-        };
-        
-        float maxTriY = fmaxf(v0.y, fmaxf(v1.y, v2.y));
-        float minTriY = fminf(v0.y, fminf(v1.y, v2.y));
-        if(maxObjectHeight < maxTriY){maxObjectHeight = maxTriY;}
-        if(minObjectHeight > minTriY){minObjectHeight = minTriY;}
-
-        if (!CheckTriangleAABBCollision(v0, v1, v2, mc->box)) 
-        {
-            continue; //no collision
+    if (cm->bvh.nodeCount == 0) return;
+    //the box has to touch the brush itself, not just its bounds, before any of its triangles can
+    if (obj->planeCount > 0) CountObjectCollisionStat(STAT_OBJECT_COLLISION, STAT_AABB_TEST, obj, 1);
+    if (obj->planeCount > 0 && !CheckCollisionBrushAABB(obj->planes, obj->planeCount, mc->box)) return;
+    ContactManifold manifold = {0};
+    //object height comes straight from the bvh root, no need to walk every triangle for it
+    float maxObjectHeight = cm->bvh.nodes[0].box.max.y;
+    float minObjectHeight = cm->bvh.nodes[0].box.min.y;
+    //only triangles in bvh leaves overlapping the player box can pass the SAT test, each leaf is one batched SAT call
+    //scratch comes from the frame arena so a detailed brush cannot blow the stack
+    //with the arena full it falls back to COLLISION_STACK_LEAVES leaves on the stack, the move is reverted if that is not all of them
+    int stackLeaves[COLLISION_STACK_LEAVES];
+    int stackHits[COLLISION_STACK_LEAVES * TRI_BATCH];
+    size_t arenaMark = FrameArenaMark();
+    int *leaves = FrameAlloc(sizeof(int) * cm->batchCount);
+    int leafCapacity = cm->batchCount;
+    if (!leaves) {
+        leaves = stackLeaves;
+        leafCapacity = cm->batchCount < COLLISION_STACK_LEAVES ? cm->batchCount : COLLISION_STACK_LEAVES;
+    }
+    int leafCount = QueryBvhLeaves(&cm->bvh, mc->box, leaves, leafCapacity);
+    bool truncated = leafCapacity < cm->batchCount && leafCount == leafCapacity;
+    int *hits = FrameAlloc(sizeof(int) * (leafCount * TRI_BATCH + 1));
+    if (!hits) {
+        hits = stackHits;
+        if (leafCount > COLLISION_STACK_LEAVES) {leafCount = COLLISION_STACK_LEAVES; truncated = true;}
+    }
+    int hitCount = 0;
+    //stats stay in locals through the kernel and the solver, one flush at the end
+    int satTests = 0;
+    int resolvePasses = 0;
+    for (int n = 0; n < leafCount; n++) {
+        const TriBatch *batch = &cm->batches[cm->nodeBatch[leaves[n]]];
+        int mask = CheckTriBatchAABB(batch, mc->box);
+        satTests += __builtin_popcount(batch->laneMask);
+        for (int lane = 0; lane < TRI_BATCH; lane++) {
+            if (mask & (1 << lane)) hits[hitCount++] = batch->tri[lane];
         }
+    }
+
+    //room for every hit, so nothing is lost unless the arena is full
+    manifold.spill = FrameAlloc(sizeof(const CollisionTri *) * (hitCount + 1));
+    manifold.spillType = FrameAlloc(sizeof(CollisionType) * (hitCount + 1));
+    if (manifold.spill && manifold.spillType) manifold.spillCapacity = hitCount;
 
-        Vector3 normal = TriangleNormal(v0, v1, v2);
-        float dotUp = Vector3DotProduct(normal, (Vector3){0, 1, 0});
+    for (int c = 0; c < hitCount; c++) {
+        const CollisionTri *tri = &cm->tris[hits[c]];
+
+        float dotUp = tri->normal.y; //dot with (0, 1, 0)
         //printf("dotUp: %f\n",dotUp);
-        if (GetTriangleHeightAtPosition(v0, v1, v2, mc->pos.x, mc->pos.z, &wallY)) {
+        if (GetCollisionTriHeight(tri, mc->pos.x, mc->pos.z, &wallY)) {
             if ((mc->oldPos.y >= wallY && mc->pos.y <= wallY) || dotUp > 0.7f) {
                 // Ground
                 if (wallY > bestGroundY && mc->pos.y - wallY < 0.25f) {
                     foundGround = true;
                     bestGroundY = wallY;
-                    colls[collCount] = (Collision) {COLLISION_TOP,v0,v1,v2,normal,GetCenterForTriangle(v0,v1,v2), wallY};
-                    collCount++;
                 }
             }
             else if (dotUp < -0.7f) {
                 // Ceiling
                 hitCeiling = true;
-                colls[collCount] = (Collision) {COLLISION_BOTTOM,v0,v1,v2,normal,GetCenterForTriangle(v0,v1,v2), wallY};
-                collCount++;
             }
             else {
                 hitSide = true;
-                colls[collCount] = (Collision) {COLLISION_SIDE,v0,v1,v2,normal,GetCenterForTriangle(v0,v1,v2), wallY};
-                collCount++;
+                AddContact(&manifold, COLLISION_SIDE, tri);
             }
         }
         else {
-            if (fabsf(maxTriY - mc->pos.y) > 0.01f) {
+            if (fabsf(tri->maxY - mc->pos.y) > 0.01f) {
                 //printf("vertical triangle, far from y position\n");
                 hitSide = true;
-                colls[collCount] = (Collision) {COLLISION_SIDE_IGNORE,v0,v1,v2,normal,GetCenterForTriangle(v0,v1,v2), wallY};
-                collCount++;
+                AddContact(&manifold, COLLISION_SIDE_IGNORE, tri);
             }
         }
     }
 
+    if (manifold.dropped > 0) CountCollisionStat(STAT_OBJECT_COLLISION, STAT_DROPPED_CONTACT, manifold.dropped);
+
     bool wasJumping = mc->isJumping;
     if ((foundGround && mc->yVelocity <= 0 && fabsf(bestGroundY - mc->pos.y) < 0.4)
         || (foundGround && !wasJumping && mc->camera.position.y > maxObjectHeight)) //only sets y
@@ -292,60 +407,38 @@ void HandleObjectCollision(MainCharacter* mc, EnvObject* obj)
     }
     if (hitSide) {//only sets x and z
         //printf("Collision type: COLLISION_SIDE\n");
-        for(int i = 0; i < collCount; i++)
+        Contact *active[MAX_CONTACTS];
+        int activeCount = 0;
+        for(int i = 0; i < manifold.count; i++)
         {
-            if(colls[i].type == COLLISION_SIDE 
-                || (colls[i].type == COLLISION_SIDE_IGNORE && !foundGround)
-                || (colls[i].type == COLLISION_SIDE_IGNORE && foundGround && maxObjectHeight > (mc->crouchHeight + mc->pos.y))
+            Contact *c = &manifold.contacts[i];
+            if(c->type == COLLISION_SIDE 
+                || (c->type == COLLISION_SIDE_IGNORE && !foundGround)
+                || (c->type == COLLISION_SIDE_IGNORE && foundGround && maxObjectHeight > (mc->crouchHeight + mc->pos.y))
             )//double ugh
             {
-                Vector3 movement = Vector3Subtract(mc->pos, mc->oldPos);
-                Vector3 slide = Vector3Subtract(movement, Vector3Scale(colls[i].normal, Vector3DotProduct(movement, colls[i].normal)));
-                Vector3 candidatePos = Vector3Add(mc->oldPos, slide);
-
-                BoundingBox testBox = mc->box;
-                Vector3 offset = Vector3Subtract(candidatePos, mc->pos);
-                testBox.min = Vector3Add(testBox.min, offset);
-                testBox.max = Vector3Add(testBox.max, offset);
-
-                if (!CheckTriangleAABBCollision(colls[i].v0, colls[i].v1, colls[i].v2, testBox)) {
-                    mc->pos.x = candidatePos.x;
-                    mc->pos.z = candidatePos.z;
-                    //printf("Slide Accepted\n");// Slide accepted
-                } else {
-                    // Push out slightly along the wall normal to avoid getting stuck
-                    const float pushOutDist = 0.01f; // tweak if needed
-                    Vector3 pushOut = Vector3Scale(colls[i].normal, pushOutDist);
-
-                    Vector3 tryPos = Vector3Add(mc->oldPos, pushOut);
-                    BoundingBox testBox2 = mc->box;
-                    Vector3 offset2 = Vector3Subtract(tryPos, mc->pos);
-                    testBox2.min = Vector3Add(testBox2.min, offset2);
-                    testBox2.max = Vector3Add(testBox2.max, offset2);
-
-                    if (!CheckTriangleAABBCollision(colls[i].v0, colls[i].v1, colls[i].v2, testBox2)) {
-                        mc->pos.x = tryPos.x;
-                        mc->pos.z = tryPos.z;
-                        //printf("Wall push-out applied\n");
-                    } else {
-                        Vector3 movement = Vector3Subtract(mc->pos, mc->oldPos);
-                        float dot = Vector3DotProduct(movement, colls[i].normal);
-                        if (dot > 0.0f) {
-                            // Moving away from wall accept movement
-                            mc->pos.x = tryPos.x; // already updated
-                            mc->pos.z = tryPos.z;
-                            //printf("Slide blocked, but pushout accepted because moving away from wall\n");
-                        } else {
-                            // Moving into wall revert
-                            mc->pos.x = mc->oldPos.x;
-                            mc->pos.z = mc->oldPos.z;
-                            //printf("Slide + push-out blocked, moving into wall\n");
-                        } 
-                    }
-                }
+                active[activeCount++] = c;
+            }
+        }
+        //same rule for the spill, kept in place at the front
+        int spillCount = 0;
+        for(int i = 0; i < manifold.spillCount; i++)
+        {
+            if(manifold.spillType[i] == COLLISION_SIDE || !foundGround || maxObjectHeight > (mc->crouchHeight + mc->pos.y))
+            {
+                manifold.spill[spillCount++] = manifold.spill[i];
             }
         }
+        if (activeCount > 0 || spillCount > 0) ResolveSideContacts(mc, active, activeCount, manifold.spill, spillCount, &satTests, &resolvePasses);
+    }
+    //walls were missed, better to stop than to walk through one
+    if (truncated || manifold.lost > 0) {
+        mc->pos.x = mc->oldPos.x;
+        mc->pos.z = mc->oldPos.z;
     }
+    FrameArenaRelease(arenaMark);
+    CountObjectCollisionStat(STAT_OBJECT_COLLISION, STAT_TRI_SAT_TEST, obj, satTests);
+    if (resolvePasses > 0) CountObjectCollisionStat(STAT_OBJECT_COLLISION, STAT_RESOLVE_PASS, obj, resolvePasses);
 }
 
 void HandleHitBoxesCollision(MainCharacter* mc, EnvObject* obj)
@@ -358,8 +451,10 @@ void HandleHitBoxesCollision(MainCharacter* mc, EnvObject* obj)
     {
         BoundingBox hitBox = obj->hitBoxes[i];
 
+        CountObjectCollisionStat(STAT_OBJECT_COLLISION, STAT_AABB_TEST, obj, 1);
         if (CheckCollisionBoxes(playerBox, hitBox))
         {
+            CountObjectCollisionStat(STAT_OBJECT_COLLISION, STAT_RESOLVE_PASS, obj, 1);
             Vector3 oldPos = mc->oldPos;
             Vector3 newPos = mc->pos;
 
@@ -485,51 +580,11 @@ void HandleMcAndBgCollision(MainCharacter* mc, Enemy* bg, GameState *gs)
     }
 }
 
-static void HandlBgPlatVerticalCollision(Enemy* bg, EnvObject* obj, Level* l, bool *isOnPlatform)
+//ground snap from the baked ground field, only surfaces of the object the bg box hit count
+static void HandlBgPlatVerticalCollision(Enemy* bg, int objIndex, Level* l, bool *isOnPlatform)
 {
-    int triangleCount = obj->model.meshes[0].triangleCount;
-    float *vertices = obj->model.meshes[0].vertices;
-
-    bool foundGround = false;
-    float bestGroundY = -INFINITY;
-    float wallY = 0.0f;
-
-    for (int i = 0; i < triangleCount; i++) {
-        Vector3 v0 = {
-            vertices[(i * 3 + 0) * 3 + 0],
-            vertices[(i * 3 + 0) * 3 + 1],
-            vertices[(i * 3 + 0) * 3 + 2]
-        };
-        Vector3 v1 = {
-            vertices[(i * 3 + 1) * 3 + 0],
-            vertices[(i * 3 + 1) * 3 + 1],
-            vertices[(i * 3 + 1) * 3 + 2]
-        };
-        Vector3 v2 = {
-            vertices[(i * 3 + 2) * 3 + 0],
-            vertices[(i * 3 + 2) * 3 + 1],
-            vertices[(i * 3 + 2) * 3 + 2]
-        };
-        
-
-        if (!CheckTriangleAABBCollision(v0, v1, v2, bg->box)) 
-        {
-            continue; //no collision
-        }
-
-        Vector3 normal = TriangleNormal(v0, v1, v2);
-        float dotUp = Vector3DotProduct(normal, (Vector3){0, 1, 0});
-        //printf("dotUp: %f\n",dotUp);
-        if (GetTriangleHeightAtPosition(v0, v1, v2, bg->pos.x, bg->pos.z, &wallY)) {
-            if ((bg->oldPos.y >= wallY && bg->pos.y <= wallY) || dotUp > 0.7f) {
-                // Ground
-                if (wallY > bestGroundY && bg->pos.y - wallY < 0.25f) {
-                    foundGround = true;
-                    bestGroundY = wallY;
-                }
-            }
-        }
-    }
+    float bestGroundY = 0.0f;
+    bool foundGround = GetGroundHeight(&l->ground, bg->box, bg->pos, bg->pos.y - 0.25f, bg->box.max.y, objIndex, &bestGroundY);
 
     if(foundGround)
     {
@@ -549,59 +604,6 @@ static void HandlBgPlatVerticalCollision(Enemy* bg, EnvObject* obj, Level* l, bo
     }
 }
 
-//no idea if this works yet
-static bool PointInTriangle2D(Vector2 pt, Vector2 v0, Vector2 v1, Vector2 v2)
-{
-    float dX = pt.x - v2.x;
-    float dY = pt.y - v2.y;
-    float dX21 = v2.x - v1.x;
-    float dY12 = v1.y - v2.y;
-    float D = dY12 * (v0.x - v2.x) + dX21 * (v0.y - v2.y);
-    float s = dY12 * dX + dX21 * dY;
-    float t = (v2.y - v0.y) * dX + (v0.x - v2.x) * dY;
-    if (D < 0) return (s <= 0 && t <= 0 && s + t >= D);
-    return (s >= 0 && t >= 0 && s + t <= D);
-}
-
-//dont know if this works, the idea here is because the soldiers are not stable with the triangle/full-mesh alg
-//for collision detection, I needed a work around to make sure that when the soldier is on an object that is not square
-//he cannot just float in the middle of the air
-static bool IsXZInsideMesh(Vector3 pos, Mesh mesh)
-{
-    int triangleCount = mesh.triangleCount;
-    float *vertices = mesh.vertices;
-
-    Vector2 p = { pos.x, pos.z };
-
-    for (int i = 0; i < triangleCount; i++)
-    {
-        Vector3 v0 = {
-            vertices[(i * 3 + 0) * 3 + 0],
-            vertices[(i * 3 + 0) * 3 + 1],
-            vertices[(i * 3 + 0) * 3 + 2]
-        };
-        Vector3 v1 = {
-            vertices[(i * 3 + 1) * 3 + 0],
-            vertices[(i * 3 + 1) * 3 + 1],
-            vertices[(i * 3 + 1) * 3 + 2]
-        };
-        Vector3 v2 = {
-            vertices[(i * 3 + 2) * 3 + 0],
-            vertices[(i * 3 + 2) * 3 + 1],
-            vertices[(i * 3 + 2) * 3 + 2]
-        };
-
-        // Project to XZ
-        Vector2 a = { v0.x, v0.z };
-        Vector2 b = { v1.x, v1.z };
-        Vector2 c = { v2.x, v2.z };
-
-        if (PointInTriangle2D(p, a, b, c)) {return true;}
-    }
-
-    return false;
-}
-
 //AABB if side collision is detected but will use mesh triangles for vertical collisions
 //this is because I want simple collision from the side with complex objects,
 //but I would like the enemies to not appear to float when a ground object has complex geometry
@@ -612,12 +614,17 @@ void HandleBgPlatCollision(Enemy* bg, Level* l)
     BoundingBox playerBox = bg->box;
     bool isOnPlatform = false;
     bool sideColl = false;
-    for(int i=0;i<l->objCount;i++)
+    int nearObj[MAX_ENV_OBJECTS];
+    int nearCount = QueryWorldGrid(&l->grid, playerBox, nearObj, MAX_ENV_OBJECTS);
+    for(int n=0;n<nearCount;n++)
     {
+        int i = nearObj[n];
         BoundingBox hitBox = l->obj[i].box;
         //printf("bg plat begin %d\n", i);
+        CountObjectCollisionStat(STAT_BG_PLAT_COLLISION, STAT_AABB_TEST, &l->obj[i], 1);
         if(CheckCollisionBoxes(playerBox,hitBox))
         {
+            CountObjectCollisionStat(STAT_BG_PLAT_COLLISION, STAT_RESOLVE_PASS, &l->obj[i], 1);
             //do stuff
             Vector3 oldPos = bg->oldPos;
             Vector3 newPos = bg->pos;
@@ -643,7 +650,7 @@ void HandleBgPlatCollision(Enemy* bg, Level* l)
             {
                 //printf("bg plat vertical collision AABB, running mesh check\n");
                 //bg->pos.y += penY;
-                if((bg->type==BG_TYPE_ARMY && IsXZInsideMesh(bg->pos, l->obj[i].model.meshes[0])) || l->obj[i].useHitBoxes)//todo: does this actually work?
+                if((bg->type==BG_TYPE_ARMY && IsXZInsideFootprint(&l->obj[i].colMesh, bg->pos.x, bg->pos.z)) || l->obj[i].useHitBoxes)//todo: does this actually work?
                 {
                     bg->pos.y = hitBox.max.y + bg->yOffset;
                     bg->yVelocity = 0;
@@ -653,7 +660,7 @@ void HandleBgPlatCollision(Enemy* bg, Level* l)
                 }
                 else
                 {
-                    HandlBgPlatVerticalCollision(bg,&l->obj[i],l,&isOnPlatform);
+                    HandlBgPlatVerticalCollision(bg,i,l,&isOnPlatform);
                 }
             }
             else if (absX < absZ)
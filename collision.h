@@ -6,6 +6,12 @@
 
 //constants for collision
 #define SKIN_WIDTH 0.1f //0.05f
+#define MAX_CONTACTS 16 //merged side contacts kept per object per frame, extra triangles spill over
+#define CONTACT_MAX_TRIS 8 //triangles kept per contact for the post slide check
+#define CONTACT_COPLANAR_DOT 0.999f //normals this close, and
+#define CONTACT_COPLANAR_DIST 0.01f //plane offsets this close, count as one plane
+#define CONTACT_SOLVER_ITERATIONS 4 //wall clipping passes, corners need two
+#define COLLISION_STACK_LEAVES 32 //bvh leaves tested from the stack when the frame arena is full
 
 //enums
 typedef enum {
@@ -16,15 +22,26 @@ typedef enum {
 } CollisionType;
 
 //structs
+//every colliding triangle on one plane, resolved as one wall
 typedef struct {
     CollisionType type;
-    Vector3 v0;
-    Vector3 v1;
-    Vector3 v2;
     Vector3 normal;
-    Vector3 center;
-    float height;
-} Collision;
+    float planeD;
+    int triCount;
+    const CollisionTri *tris[CONTACT_MAX_TRIS]; //point into the object's collision mesh
+} Contact;
+
+typedef struct {
+    Contact contacts[MAX_CONTACTS];
+    int count;
+    //triangles that did not fit in contacts, frame arena scratch, still clipped against and checked
+    const CollisionTri **spill;
+    CollisionType *spillType;
+    int spillCount;
+    int spillCapacity;
+    int dropped; //contacts or triangles that did not fit in contacts
+    int lost; //dropped ones the spill had no room for either, the side move is reverted
+} ContactManifold;
 
 //functions
 void HandleObjectCollision(MainCharacter* mc, EnvObject* obj);
@@ -0,0 +1,330 @@
+#include "collision_mesh.h"
+#include "bvh.h"
+#include "raylib.h"
+#include "raymath.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#if defined(COLLISION_SIMD_SSE2)
+    #include <emmintrin.h>
+#elif defined(COLLISION_SIMD_NEON)
+    #include <arm_neon.h>
+#endif
+
+//the simd and scalar SAT paths must agree bit for bit, so keep gcc from fusing their mul+add into fma
+#if defined(__GNUC__) && !defined(__clang__)
+    #pragma GCC optimize ("fp-contract=off")
+#endif
+
+static CollisionTri MakeCollisionTri(Vector3 v0, Vector3 v1, Vector3 v2)
+{
+    CollisionTri t = {0};
+    t.v0 = v0;
+    t.v1 = v1;
+    t.v2 = v2;
+    t.normal = Vector3Normalize(Vector3CrossProduct(Vector3Subtract(v1, v0), Vector3Subtract(v2, v0)));
+    t.planeD = -Vector3DotProduct(t.normal, v0);
+    t.minY = fminf(v0.y, fminf(v1.y, v2.y));
+    t.maxY = fmaxf(v0.y, fmaxf(v1.y, v2.y));
+
+    //same axis order CheckTriangleAABBCollision uses, minus the 3 box axes
+    Vector3 edges[3] = { Vector3Subtract(v1, v0), Vector3Subtract(v2, v1), Vector3Subtract(v0, v2) };
+    Vector3 boxAxes[3] = { {1, 0, 0}, {0, 1, 0}, {0, 0, 1} };
+    t.axes[0] = t.normal;
+    for(int e = 0; e < 3; e++)
+    {
+        for(int a = 0; a < 3; a++)
+        {
+            t.axes[1 + e * 3 + a] = Vector3CrossProduct(edges[e], boxAxes[a]);
+        }
+    }
+    return t;
+}
+
+//one TriBatch per bvh leaf, so a leaf query hands the kernel whole batches
+static void BuildTriBatches(CollisionMesh *cm)
+{
+    cm->nodeBatch = MemAlloc(sizeof(int) * cm->bvh.nodeCount);
+    int leafCount = 0;
+    for(int n = 0; n < cm->bvh.nodeCount; n++)
+    {
+        if(cm->bvh.nodes[n].left < 0){leafCount++;}
+    }
+    cm->batches = MemAlloc(sizeof(TriBatch) * leafCount);
+    cm->batchCount = 0;
+
+    for(int n = 0; n < cm->bvh.nodeCount; n++)
+    {
+        const BvhNode *node = &cm->bvh.nodes[n];
+        if(node->left >= 0){cm->nodeBatch[n] = -1; continue;}
+
+        TriBatch *b = &cm->batches[cm->batchCount];
+        b->laneMask = 0;
+        for(int lane = 0; lane < TRI_BATCH; lane++)
+        {
+            int slot = lane < node->count ? lane : 0; //padding lanes repeat the first triangle
+            int t = cm->bvh.prims[node->first + slot];
+            const CollisionTri *tri = &cm->tris[t];
+            b->tri[lane] = t;
+            if(lane < node->count){b->laneMask |= 1 << lane;}
+
+            b->v[0][lane] = tri->v0.x; b->v[1][lane] = tri->v0.y; b->v[2][lane] = tri->v0.z;
+            b->v[3][lane] = tri->v1.x; b->v[4][lane] = tri->v1.y; b->v[5][lane] = tri->v1.z;
+            b->v[6][lane] = tri->v2.x; b->v[7][lane] = tri->v2.y; b->v[8][lane] = tri->v2.z;
+            for(int a = 0; a < TRI_SAT_AXES; a++)
+            {
+                b->axes[a * 3 + 0][lane] = tri->axes[a].x;
+                b->axes[a * 3 + 1][lane] = tri->axes[a].y;
+                b->axes[a * 3 + 2][lane] = tri->axes[a].z;
+            }
+        }
+        cm->nodeBatch[n] = cm->batchCount++;
+    }
+}
+
+static int ComparePointsXZ(const void *a, const void *b)
+{
+    const Vector2 *pa = a;
+    const Vector2 *pb = b;
+    if(pa->x != pb->x){return (pa->x < pb->x) ? -1 : 1;}
+    if(pa->y != pb->y){return (pa->y < pb->y) ? -1 : 1;}
+    return 0;
+}
+
+//z of the 2d cross product (a - o) x (b - o), positive when o->a->b turns counter clockwise
+static float Cross2D(Vector2 o, Vector2 a, Vector2 b)
+{
+    return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+//monotone chain hull of every vertex projected to x/z, collinear points are dropped
+static void BuildFootprint(CollisionMesh *cm)
+{
+    int n = cm->triCount * 3;
+    Vector2 *pts = MemAlloc(sizeof(Vector2) * n);
+    for(int i = 0; i < cm->triCount; i++)
+    {
+        pts[i * 3 + 0] = (Vector2){ cm->tris[i].v0.x, cm->tris[i].v0.z };
+        pts[i * 3 + 1] = (Vector2){ cm->tris[i].v1.x, cm->tris[i].v1.z };
+        pts[i * 3 + 2] = (Vector2){ cm->tris[i].v2.x, cm->tris[i].v2.z };
+    }
+    qsort(pts, n, sizeof(Vector2), ComparePointsXZ);
+
+    Vector2 *hull = MemAlloc(sizeof(Vector2) * (n + 1));
+    int k = 0;
+    for(int i = 0; i < n; i++) //lower chain
+    {
+        while(k >= 2 && Cross2D(hull[k - 2], hull[k - 1], pts[i]) <= 0.0f){k--;}
+        hull[k++] = pts[i];
+    }
+    for(int i = n - 2, lower = k + 1; i >= 0; i--) //upper chain
+    {
+        while(k >= lower && Cross2D(hull[k - 2], hull[k - 1], pts[i]) <= 0.0f){k--;}
+        hull[k++] = pts[i];
+    }
+    MemFree(pts);
+
+    cm->footprintCount = (k > 1) ? k - 1 : k; //last point repeats the first
+    if(cm->footprintCount < 3) //flat in x/z, nothing can stand on it
+    {
+        MemFree(hull);
+        cm->footprintCount = 0;
+        return;
+    }
+    cm->footprint = hull;
+}
+
+CollisionMesh BuildCollisionMesh(Mesh mesh)
+{
+    CollisionMesh cm = {0};
+    if(mesh.triangleCount <= 0 || mesh.vertices == NULL){return cm;}
+
+    cm.triCount = mesh.triangleCount;
+    cm.tris = MemAlloc(sizeof(CollisionTri) * cm.triCount);
+    BoundingBox *boxes = MemAlloc(sizeof(BoundingBox) * cm.triCount);
+    for(int i = 0; i < cm.triCount; i++)
+    {
+        Vector3 v[3];
+        for(int j = 0; j < 3; j++)
+        {
+            int idx = mesh.indices ? mesh.indices[i * 3 + j] : i * 3 + j;
+            v[j] = (Vector3){ mesh.vertices[idx * 3 + 0], mesh.vertices[idx * 3 + 1], mesh.vertices[idx * 3 + 2] };
+        }
+        cm.tris[i] = MakeCollisionTri(v[0], v[1], v[2]);
+        boxes[i] = (BoundingBox){ Vector3Min(v[0], Vector3Min(v[1], v[2])), Vector3Max(v[0], Vector3Max(v[1], v[2])) };
+    }
+    cm.bvh = BuildBvh(boxes, cm.triCount);
+    MemFree(boxes);
+    BuildTriBatches(&cm);
+    BuildFootprint(&cm);
+    return cm;
+}
+
+void UnloadCollisionMesh(CollisionMesh *cm)
+{
+    if(cm->tris){MemFree(cm->tris);}
+    if(cm->batches){MemFree(cm->batches);}
+    if(cm->nodeBatch){MemFree(cm->nodeBatch);}
+    if(cm->footprint){MemFree(cm->footprint);}
+    UnloadBvh(&cm->bvh);
+    *cm = (CollisionMesh){0};
+}
+
+//interpolated y on the triangle plane at x/z, false for vertical triangles
+bool GetCollisionTriHeight(const CollisionTri *tri, float x, float z, float *outY)
+{
+    if(fabsf(tri->normal.y) < 1e-6f){return false;}
+    *outY = -(tri->normal.x * x + tri->normal.z * z + tri->planeD) / tri->normal.y;
+    return true;
+}
+
+// SAT in center/extent form: with p = dot(v - boxCenter, axis) and r = dot(boxExtents, |axis|)
+// the triangle is separated on the axis when min(p) > r or max(p) < -r, a zero axis never separates
+static bool SeparatedLane(float p0, float p1, float p2, float r)
+{
+    float mn = p0 < p1 ? p0 : p1;
+    mn = mn < p2 ? mn : p2;
+    float mx = p0 > p1 ? p0 : p1;
+    mx = mx > p2 ? mx : p2;
+    return mn > r || mx < -r;
+}
+
+//scalar SAT for one triangle, v holds v0.xyz v1.xyz v2.xyz and axes the cached axes xyz
+static bool TriLaneOverlaps(const float *v, const float *axes, Vector3 c, Vector3 e)
+{
+    float x0 = v[0] - c.x, y0 = v[1] - c.y, z0 = v[2] - c.z;
+    float x1 = v[3] - c.x, y1 = v[4] - c.y, z1 = v[5] - c.z;
+    float x2 = v[6] - c.x, y2 = v[7] - c.y, z2 = v[8] - c.z;
+
+    //box axes first, cheapest and they reject the most
+    if(SeparatedLane(x0, x1, x2, e.x)){return false;}
+    if(SeparatedLane(y0, y1, y2, e.y)){return false;}
+    if(SeparatedLane(z0, z1, z2, e.z)){return false;}
+
+    for(int a = 0; a < TRI_SAT_AXES; a++)
+    {
+        float ax = axes[a * 3 + 0], ay = axes[a * 3 + 1], az = axes[a * 3 + 2];
+        float p0 = (ax * x0 + ay * y0) + az * z0;
+        float p1 = (ax * x1 + ay * y1) + az * z1;
+        float p2 = (ax * x2 + ay * y2) + az * z2;
+        float r = (e.x * fabsf(ax) + e.y * fabsf(ay)) + e.z * fabsf(az);
+        if(SeparatedLane(p0, p1, p2, r)){return false;}
+    }
+    return true;
+}
+
+//single triangle version of the kernel, same answer as its lane in CheckTriBatchAABB
+bool CheckCollisionTriAABB(const CollisionTri *tri, BoundingBox box)
+{
+    Vector3 c = Vector3Scale(Vector3Add(box.min, box.max), 0.5f);
+    Vector3 e = Vector3Scale(Vector3Subtract(box.max, box.min), 0.5f);
+    float v[9] = { tri->v0.x, tri->v0.y, tri->v0.z, tri->v1.x, tri->v1.y, tri->v1.z, tri->v2.x, tri->v2.y, tri->v2.z };
+    return TriLaneOverlaps(v, &tri->axes[0].x, c, e);
+}
+
+//tests every triangle in the batch against box at once, returns a bit per lane that overlaps
+int CheckTriBatchAABB(const TriBatch *b, BoundingBox box)
+{
+    Vector3 c = Vector3Scale(Vector3Add(box.min, box.max), 0.5f);
+    Vector3 e = Vector3Scale(Vector3Subtract(box.max, box.min), 0.5f);
+
+#if defined(COLLISION_SIMD_SSE2)
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    __m128 cx = _mm_set1_ps(c.x), cy = _mm_set1_ps(c.y), cz = _mm_set1_ps(c.z);
+    __m128 ex = _mm_set1_ps(e.x), ey = _mm_set1_ps(e.y), ez = _mm_set1_ps(e.z);
+    __m128 x0 = _mm_sub_ps(_mm_loadu_ps(b->v[0]), cx), y0 = _mm_sub_ps(_mm_loadu_ps(b->v[1]), cy), z0 = _mm_sub_ps(_mm_loadu_ps(b->v[2]), cz);
+    __m128 x1 = _mm_sub_ps(_mm_loadu_ps(b->v[3]), cx), y1 = _mm_sub_ps(_mm_loadu_ps(b->v[4]), cy), z1 = _mm_sub_ps(_mm_loadu_ps(b->v[5]), cz);
+    __m128 x2 = _mm_sub_ps(_mm_loadu_ps(b->v[6]), cx), y2 = _mm_sub_ps(_mm_loadu_ps(b->v[7]), cy), z2 = _mm_sub_ps(_mm_loadu_ps(b->v[8]), cz);
+
+    #define SAT_SEPARATED(p0, p1, p2, r) _mm_or_ps( \
+        _mm_cmpgt_ps(_mm_min_ps(_mm_min_ps(p0, p1), p2), r), \
+        _mm_cmplt_ps(_mm_max_ps(_mm_max_ps(p0, p1), p2), _mm_xor_ps(r, signMask)))
+
+    __m128 sep = SAT_SEPARATED(x0, x1, x2, ex);
+    sep = _mm_or_ps(sep, SAT_SEPARATED(y0, y1, y2, ey));
+    sep = _mm_or_ps(sep, SAT_SEPARATED(z0, z1, z2, ez));
+    for(int a = 0; a < TRI_SAT_AXES; a++)
+    {
+        if((_mm_movemask_ps(sep) & b->laneMask) == b->laneMask){return 0;}
+        __m128 ax = _mm_loadu_ps(b->axes[a * 3 + 0]);
+        __m128 ay = _mm_loadu_ps(b->axes[a * 3 + 1]);
+        __m128 az = _mm_loadu_ps(b->axes[a * 3 + 2]);
+        __m128 p0 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, x0), _mm_mul_ps(ay, y0)), _mm_mul_ps(az, z0));
+        __m128 p1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, x1), _mm_mul_ps(ay, y1)), _mm_mul_ps(az, z1));
+        __m128 p2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, x2), _mm_mul_ps(ay, y2)), _mm_mul_ps(az, z2));
+        __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ex, _mm_andnot_ps(signMask, ax)), _mm_mul_ps(ey, _mm_andnot_ps(signMask, ay))),
+                              _mm_mul_ps(ez, _mm_andnot_ps(signMask, az)));
+        sep = _mm_or_ps(sep, SAT_SEPARATED(p0, p1, p2, r));
+    }
+    #undef SAT_SEPARATED
+    return ~_mm_movemask_ps(sep) & b->laneMask;
+#elif defined(COLLISION_SIMD_NEON)
+    float32x4_t cx = vdupq_n_f32(c.x), cy = vdupq_n_f32(c.y), cz = vdupq_n_f32(c.z);
+    float32x4_t ex = vdupq_n_f32(e.x), ey = vdupq_n_f32(e.y), ez = vdupq_n_f32(e.z);
+    float32x4_t x0 = vsubq_f32(vld1q_f32(b->v[0]), cx), y0 = vsubq_f32(vld1q_f32(b->v[1]), cy), z0 = vsubq_f32(vld1q_f32(b->v[2]), cz);
+    float32x4_t x1 = vsubq_f32(vld1q_f32(b->v[3]), cx), y1 = vsubq_f32(vld1q_f32(b->v[4]), cy), z1 = vsubq_f32(vld1q_f32(b->v[5]), cz);
+    float32x4_t x2 = vsubq_f32(vld1q_f32(b->v[6]), cx), y2 = vsubq_f32(vld1q_f32(b->v[7]), cy), z2 = vsubq_f32(vld1q_f32(b->v[8]), cz);
+
+    #define SAT_SEPARATED(p0, p1, p2, r) vorrq_u32( \
+        vcgtq_f32(vminq_f32(vminq_f32(p0, p1), p2), r), \
+        vcltq_f32(vmaxq_f32(vmaxq_f32(p0, p1), p2), vnegq_f32(r)))
+    #define SAT_LANE_BITS(s) ((int)(vgetq_lane_u32(s, 0) & 1) | (int)(vgetq_lane_u32(s, 1) & 2) \
+        | (int)(vgetq_lane_u32(s, 2) & 4) | (int)(vgetq_lane_u32(s, 3) & 8))
+
+    uint32x4_t sep = SAT_SEPARATED(x0, x1, x2, ex);
+    sep = vorrq_u32(sep, SAT_SEPARATED(y0, y1, y2, ey));
+    sep = vorrq_u32(sep, SAT_SEPARATED(z0, z1, z2, ez));
+    for(int a = 0; a < TRI_SAT_AXES; a++)
+    {
+        if((SAT_LANE_BITS(sep) & b->laneMask) == b->laneMask){return 0;}
+        float32x4_t ax = vld1q_f32(b->axes[a * 3 + 0]);
+        float32x4_t ay = vld1q_f32(b->axes[a * 3 + 1]);
+        float32x4_t az = vld1q_f32(b->axes[a * 3 + 2]);
+        float32x4_t p0 = vaddq_f32(vaddq_f32(vmulq_f32(ax, x0), vmulq_f32(ay, y0)), vmulq_f32(az, z0));
+        float32x4_t p1 = vaddq_f32(vaddq_f32(vmulq_f32(ax, x1), vmulq_f32(ay, y1)), vmulq_f32(az, z1));
+        float32x4_t p2 = vaddq_f32(vaddq_f32(vmulq_f32(ax, x2), vmulq_f32(ay, y2)), vmulq_f32(az, z2));
+        float32x4_t r = vaddq_f32(vaddq_f32(vmulq_f32(ex, vabsq_f32(ax)), vmulq_f32(ey, vabsq_f32(ay))), vmulq_f32(ez, vabsq_f32(az)));
+        sep = vorrq_u32(sep, SAT_SEPARATED(p0, p1, p2, r));
+    }
+    int sepBits = SAT_LANE_BITS(sep);
+    #undef SAT_SEPARATED
+    #undef SAT_LANE_BITS
+    return ~sepBits & b->laneMask;
+#else
+    int mask = 0;
+    for(int lane = 0; lane < TRI_BATCH; lane++)
+    {
+        if(!(b->laneMask & (1 << lane))){continue;}
+        float v[9];
+        float axes[TRI_SAT_AXES * 3];
+        for(int i = 0; i < 9; i++){v[i] = b->v[i][lane];}
+        for(int i = 0; i < TRI_SAT_AXES * 3; i++){axes[i] = b->axes[i][lane];}
+        if(TriLaneOverlaps(v, axes, c, e)){mask |= 1 << lane;}
+    }
+    return mask;
+#endif
+}
+
+//is x/z over the footprint, edges count as inside. binary search for the fan wedge around footprint[0], O(log n)
+bool IsXZInsideFootprint(const CollisionMesh *cm, float x, float z)
+{
+    const float eps = 1e-5f;
+    const Vector2 *h = cm->footprint;
+    int n = cm->footprintCount;
+    if(n < 3){return false;}
+
+    Vector2 p = { x, z };
+    if(Cross2D(h[0], h[1], p) < -eps || Cross2D(h[0], h[n - 1], p) > eps){return false;}
+
+    int lo = 1;
+    int hi = n - 1;
+    while(hi - lo > 1)
+    {
+        int mid = (lo + hi) / 2;
+        if(Cross2D(h[0], h[mid], p) >= 0.0f){lo = mid;}
+        else{hi = mid;}
+    }
+    return Cross2D(h[lo], h[lo + 1], p) >= -eps;
+}
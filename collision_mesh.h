@@ -0,0 +1,62 @@
+#ifndef COLLISION_MESH_H
+#define COLLISION_MESH_H
+
+#include "raylib.h"
+#include "bvh.h"
+
+//constants
+#define TRI_SAT_AXES 10 //triangle normal + 3 edges crossed with the 3 box axes, box axes themselves are implicit
+#define TRI_BATCH 4 //triangles per SAT kernel call, one bvh leaf fits in one batch
+
+#if BVH_LEAF_SIZE > TRI_BATCH
+#error "a bvh leaf must fit in one TriBatch"
+#endif
+
+//pick the SAT kernel path, anything else (web, armv6 pi builds) uses the scalar lanes
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define COLLISION_SIMD_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #define COLLISION_SIMD_NEON
+#endif
+
+//structs
+//everything collision needs from one static triangle, computed once at load
+typedef struct {
+    Vector3 v0;
+    Vector3 v1;
+    Vector3 v2;
+    Vector3 normal; //unit normal
+    float planeD; //dot(normal, p) + planeD == 0 for points on the triangle plane
+    float minY;
+    float maxY;
+    Vector3 axes[TRI_SAT_AXES];
+} CollisionTri;
+
+//structure of arrays copy of up to TRI_BATCH tris, one lane per triangle
+typedef struct {
+    float v[9][TRI_BATCH]; //v0.xyz, v1.xyz, v2.xyz
+    float axes[TRI_SAT_AXES * 3][TRI_BATCH]; //xyz of every cached axis
+    int tri[TRI_BATCH]; //index into tris, padding lanes repeat lane 0
+    int laneMask; //bit per lane holding a real triangle
+} TriBatch;
+
+typedef struct {
+    CollisionTri *tris;
+    int triCount;
+    Bvh bvh; //over tris, node 0 bounds the whole mesh
+    TriBatch *batches; //one per bvh leaf
+    int batchCount;
+    int *nodeBatch; //bvh node index -> batch index, -1 for inner nodes
+    Vector2 *footprint; //convex hull of the mesh projected to x/z, counter clockwise, brushes are convex so this is exact
+    int footprintCount;
+} CollisionMesh;
+
+//functions
+CollisionMesh BuildCollisionMesh(Mesh mesh);
+void UnloadCollisionMesh(CollisionMesh *cm);
+bool GetCollisionTriHeight(const CollisionTri *tri, float x, float z, float *outY);
+bool CheckCollisionTriAABB(const CollisionTri *tri, BoundingBox box);
+int CheckTriBatchAABB(const TriBatch *batch, BoundingBox box);
+bool IsXZInsideFootprint(const CollisionMesh *cm, float x, float z);
+
+#endif // COLLISION_MESH_H
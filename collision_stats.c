@@ -0,0 +1,107 @@
+#include "collision_stats.h"
+#include "raylib.h"
+#include "raymath.h"
+#include <stdio.h>
+
+static const char *callerNames[STAT_CALLER_COUNT] = { "object", "bg_plat", "shoot_ray", "bg_los", "bg_shot" };
+static const char *kindNames[STAT_KIND_COUNT] = { "aabb", "tri_sat", "ray_box", "resolve", "dropped" };
+
+//counts for the frame in progress, cleared by EndCollisionStatsFrame
+static int frameCounts[STAT_CALLER_COUNT][STAT_KIND_COUNT];
+static int frameNumber = 0;
+static float maxHeat = 0.0f; //hottest object last frame, the tint scale
+static FILE *csv = NULL;
+
+void CountCollisionStat(StatCaller caller, StatKind kind, int n)
+{
+    frameCounts[caller][kind] += n;
+}
+
+void CountObjectCollisionStat(StatCaller caller, StatKind kind, EnvObject *obj, int n)
+{
+    frameCounts[caller][kind] += n;
+    obj->collisionCost += n;
+}
+
+//counts the tests of the last l->raycast query, the prims are charged to their objects, the bvh nodes only to caller
+void CountRaycastStats(Level *l, StatCaller caller)
+{
+    const RaycastScene *s = &l->raycast;
+    int objTests = 0;
+    for(int i = 0; i < s->touchedCount; i++)
+    {
+        int o = s->touched[i];
+        CountObjectCollisionStat(caller, STAT_RAY_BOX_TEST, &l->obj[o], s->objTests[o]);
+        objTests += s->objTests[o];
+    }
+    CountCollisionStat(caller, STAT_RAY_BOX_TEST, s->lastTests - objTests);
+}
+
+//call once at the end of the update, folds this frame's per object cost into the heat and writes the csv row
+void EndCollisionStatsFrame(Level *l)
+{
+    maxHeat = 0.0f;
+    for(int i = 0; i < l->objCount; i++)
+    {
+        EnvObject *obj = &l->obj[i];
+        obj->collisionHeat = obj->collisionHeat * COLLISION_HEAT_SMOOTHING + obj->collisionCost * (1.0f - COLLISION_HEAT_SMOOTHING);
+        obj->collisionCost = 0;
+        if(obj->collisionHeat > maxHeat){maxHeat = obj->collisionHeat;}
+    }
+
+    if(csv)
+    {
+        fprintf(csv, "%d", frameNumber);
+        for(int c = 0; c < STAT_CALLER_COUNT; c++)
+        {
+            for(int k = 0; k < STAT_KIND_COUNT; k++){fprintf(csv, ",%d", frameCounts[c][k]);}
+        }
+        fprintf(csv, ",%d,%d,%d\n", l->los.hits, l->los.misses, l->los.batchRays);
+    }
+
+    for(int c = 0; c < STAT_CALLER_COUNT; c++)
+    {
+        for(int k = 0; k < STAT_KIND_COUNT; k++){frameCounts[c][k] = 0;}
+    }
+    frameNumber++;
+}
+
+//white for objects that cost nothing, red for the most expensive one
+Color GetCollisionHeatColor(const EnvObject *obj)
+{
+    if(maxHeat <= 0.0f){return WHITE;}
+    float t = Clamp(obj->collisionHeat / maxHeat, 0.0f, 1.0f);
+    return (Color){ 255, (unsigned char)(255 * (1.0f - t)), (unsigned char)(255 * (1.0f - t)), 255 };
+}
+
+//starts a fresh csv of per frame totals, or closes the one being written, returns true while recording
+bool ToggleCollisionStatsCsv(void)
+{
+    if(csv)
+    {
+        CloseCollisionStatsCsv();
+        return false;
+    }
+    csv = fopen(COLLISION_STATS_CSV, "w");
+    if(!csv)
+    {
+        printf("could not open %s\n", COLLISION_STATS_CSV);
+        return false;
+    }
+    fprintf(csv, "frame");
+    for(int c = 0; c < STAT_CALLER_COUNT; c++)
+    {
+        for(int k = 0; k < STAT_KIND_COUNT; k++){fprintf(csv, ",%s_%s", callerNames[c], kindNames[k]);}
+    }
+    fprintf(csv, ",los_cache_hits,los_cache_misses,los_batch_rays\n");
+    printf("recording collision stats to %s\n", COLLISION_STATS_CSV);
+    return true;
+}
+
+void CloseCollisionStatsCsv(void)
+{
+    if(!csv){return;}
+    fclose(csv);
+    csv = NULL;
+    printf("collision stats written to %s\n", COLLISION_STATS_CSV);
+}
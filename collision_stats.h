@@ -0,0 +1,39 @@
+#ifndef COLLISION_STATS_H
+#define COLLISION_STATS_H
+
+#include "raylib.h"
+#include "level.h"
+
+//constants
+#define COLLISION_STATS_CSV "collision_stats.csv"
+#define COLLISION_HEAT_SMOOTHING 0.9f //how much of last frame's heat an object keeps, stops the tint from flickering
+
+//enums
+typedef enum {
+    STAT_OBJECT_COLLISION, //HandleObjectCollision + HandleHitBoxesCollision, the player
+    STAT_BG_PLAT_COLLISION, //HandleBgPlatCollision
+    STAT_SHOOT_RAY, //ShootRay
+    STAT_BG_LINE_OF_SIGHT, //BgLineOfSightToMc
+    STAT_BG_SHOT_PLAYER, //HandleBgShotPlayer
+    STAT_CALLER_COUNT
+} StatCaller;
+
+typedef enum {
+    STAT_AABB_TEST,
+    STAT_TRI_SAT_TEST,
+    STAT_RAY_BOX_TEST,
+    STAT_RESOLVE_PASS,
+    STAT_DROPPED_CONTACT, //side triangles that did not fit the contact manifold
+    STAT_KIND_COUNT
+} StatKind;
+
+//functions
+void CountCollisionStat(StatCaller caller, StatKind kind, int n);
+void CountObjectCollisionStat(StatCaller caller, StatKind kind, EnvObject *obj, int n); //also charges obj
+void CountRaycastStats(Level *l, StatCaller caller);
+void EndCollisionStatsFrame(Level *l);
+Color GetCollisionHeatColor(const EnvObject *obj);
+bool ToggleCollisionStatsCsv(void);
+void CloseCollisionStatsCsv(void);
+
+#endif // COLLISION_STATS_H
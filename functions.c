@@ -3,6 +3,8 @@
 #include "timer.h"
 #include "collision.h"
 #include "functions.h"
+#include "collision_stats.h"
+#include "los.h"
 #include "raylib.h"
 #include "raymath.h"
 #include "rlgl.h"
@@ -12,89 +14,6 @@
 #include <string.h>
 #include <time.h>
 
-void DrawTriangles(Model *m, bool useOrigin, Vector3 origin)
-{
-    for(int j=0; j<m->meshCount; j++)
-    {
-        int triangleCount = m->meshes[j].triangleCount;
-        float *vertices = m->meshes[j].vertices;
-        for (int i = 0; i < triangleCount; i++) {
-            Vector3 v0 = {
-                vertices[(i * 3 + 0) * 3 + 0],
-                vertices[(i * 3 + 0) * 3 + 1],
-                vertices[(i * 3 + 0) * 3 + 2]
-            };
-            Vector3 v1 = {
-                vertices[(i * 3 + 1) * 3 + 0],
-                vertices[(i * 3 + 1) * 3 + 1],
-                vertices[(i * 3 + 1) * 3 + 2]
-            };
-            Vector3 v2 = {
-                vertices[(i * 3 + 2) * 3 + 0],
-                vertices[(i * 3 + 2) * 3 + 1],
-                vertices[(i * 3 + 2) * 3 + 2]
-            };
-            if(useOrigin)
-            {
-                v0 = Vector3Add(v0,origin);
-                v1 = Vector3Add(v1,origin);
-                v2 = Vector3Add(v2,origin);
-            }
-            //DrawTriangle3D(v0,v1,v2,RED);
-            DrawLine3D(v0,v1,RED);
-            DrawLine3D(v1,v2,RED);
-            DrawLine3D(v2,v0,RED);
-        }
-    }
-}
-
-void DrawTrianglesIndexed(Model *m, bool useOrigin, Vector3 origin)
-{
-    for(int j=0; j<m->meshCount; j++)
-    {
-        int triangleCount = m->meshes[j].triangleCount;
-        float *vertices = m->meshes[j].vertices;
-        unsigned short *indices = m->meshes[j].indices;  // Check the format if not ushort
-
-        for (int i = 0; i < triangleCount; i++) {
-            int i0 = indices[i * 3 + 0];
-            int i1 = indices[i * 3 + 1];
-            int i2 = indices[i * 3 + 2];
-
-            Vector3 v0 = {
-                vertices[i0 * 3 + 0],
-                vertices[i0 * 3 + 1],
-                vertices[i0 * 3 + 2]
-            };
-            Vector3 v1 = {
-                vertices[i1 * 3 + 0],
-                vertices[i1 * 3 + 1],
-                vertices[i1 * 3 + 2]
-            };
-            Vector3 v2 = {
-                vertices[i2 * 3 + 0],
-                vertices[i2 * 3 + 1],
-                vertices[i2 * 3 + 2]
-            };
-
-            if (useOrigin) {
-                v0 = Vector3Add(v0, origin);
-                v1 = Vector3Add(v1, origin);
-                v2 = Vector3Add(v2, origin);
-            }
-
-            DrawLine3D(v0, v1, RED);
-            DrawLine3D(v1, v2, RED);
-            DrawLine3D(v2, v0, RED);
-        }
-    }
-}
-
-bool IsModelIndexed(Model *m)
-{
-    return m->meshes[0].vertexCount != (m->meshes[0].triangleCount * 3)||m->meshes[0].indices != NULL;
-}
-
 void DrawHealthBar(Vector2 position, float width, float height, float healthPercent)
 {
     // Background (empty bar)
@@ -134,84 +53,152 @@ void DrawGunHeld(Model gunModel, Camera camera, Vector3 gunPos, float rot)
     EndMode3D();
 }
 
+//applies the summed pellets of one shot to bad guy i, a single hit state, sound and death check no matter how many pellets landed
+static void ApplyShotToBg(Level *l, int i, float damn, float points, bool headShot)
+{
+    l->bg[i].health -= damn; // subtract hit
+    l->mc.score += ((int) points);
+    l->bg[i].state = BG_STATE_HIT;
+    l->bg[i].anim = l->bg[i].type==BG_TYPE_ARMY?ANIM_HIT:ANIM_YETI_ROAR;
+    l->bg[i].curFrame = l->bg[i].type==BG_TYPE_ARMY?60:0; //hit anim is delayed with standing still, skip ahead unless yeti
+    if(l->bg[i].health <= 0 || (l->bg[i].type==BG_TYPE_ARMY && headShot))//bg is dead
+    {
+        l->bg[i].health = 0;
+        l->bg[i].state = BG_STATE_DYING;
+        l->bg[i].anim = l->bg[i].type==BG_TYPE_ARMY?ANIM_DEATH:ANIM_YETI_ROAR;
+        l->bg[i].curFrame = 0;
+        StartTimer(&l->bg[i].t_yeti_death_wait);
+        printf("Bad guy %d dead!\n", i);
+        if(!IsSoundPlaying(l->bg[i].deathSound)){PlaySound(l->bg[i].deathSound);}
+    }//mark if dying as needed
+    else //if hit but still alive
+    {
+        if(!IsSoundPlaying(l->bg[i].hitSound)){PlaySound(l->bg[i].hitSound);}
+    }
+}
+
+//cheap reject box for a shot, the animated bone bounds swung through any yaw, or the fixed box without bones
+static BoundingBox GetBgShotBox(const Enemy *bg)
+{
+    if(!bg->boneHits){return bg->box;}
+    BoundingBox pose = bg->poseBox;
+    float rx = fmaxf(fabsf(pose.min.x), fabsf(pose.max.x));
+    float rz = fmaxf(fabsf(pose.min.z), fabsf(pose.max.z));
+    float r = sqrtf(rx * rx + rz * rz);
+    return (BoundingBox){ (Vector3){ bg->pos.x - r, bg->pos.y + pose.min.y, bg->pos.z - r }, (Vector3){ bg->pos.x + r, bg->pos.y + pose.max.y, bg->pos.z + r } };
+}
+
+//fires the current weapon, one ray per pellet, all pellets go through the bad guys and the world as one packet
 void ShootRay(Level *l)
 {
-    // Step 1: Create a ray from the camera
+    Weapon *w = &l->mc.weapons[l->mc.curWeaponIndex];
+    // Step 1: Create the pellet rays from the camera, the first pellet goes dead center
     Vector3 origin = l->mc.camera.position;
     Vector3 direction = Vector3Normalize(Vector3Subtract(l->mc.camera.target, l->mc.camera.position));
-    Ray bulletRay = (Ray){ origin, direction };
-    bool hit = false;
-    bool headShot = false;
-    bool bodyShot = false;
-    float minDistance = INFINITY;
-    int minIndex = 0;
-    float points = 0;
-    // Step 2: Check for hit against all bad guys
-    for (int i = 0; i < l->bgCount; i++)
+    Vector3 side = Vector3Normalize(Vector3CrossProduct(direction, l->mc.camera.up));
+    Vector3 up = Vector3CrossProduct(side, direction);
+    int pellets = w->pellets < 1 ? 1 : (w->pellets > RAY_PACKET_MAX ? RAY_PACKET_MAX : w->pellets);
+    Ray rays[RAY_PACKET_MAX];
+    for (int p = 0; p < pellets; p++)
     {
-        if (!l->bg[i].dead && l->bg[i].state != BG_STATE_DYING)
+        Vector3 dir = direction;
+        if(p > 0)//uniform over the cone cap
         {
-            RayCollision coll = GetRayCollisionBox(bulletRay, l->bg[i].box);
-            RayCollision collBody = GetRayCollisionBox(bulletRay, l->bg[i].bodyBox);
-            RayCollision collHead = GetRayCollisionBox(bulletRay, l->bg[i].headBox);
-            //todo: collision detect walls with shorter distance collsions, ie. I can shoot through walls right now
-            if (coll.hit && coll.distance < l->mc.weapons[l->mc.curWeaponIndex].maxDist)
-            {
-                printf("Bad guy %d hit, not yet accepted, distance %f\n", i, coll.distance);
-                if(minDistance > coll.distance)
-                {
-                    minDistance = coll.distance;minIndex = i;
-                    hit=true;
-                    bodyShot = collBody.hit;
-                    headShot = collHead.hit;
-                }
-            }
-            else if (coll.hit && coll.distance >= l->mc.weapons[l->mc.curWeaponIndex].maxDist){printf("Bad guy %d out of range!\n", i);}
+            float angle = RandRange(0.0f, 2.0f * PI);
+            float off = tanf(w->spread * sqrtf(RandRange(0.0f, 1.0f)));
+            dir = Vector3Add(dir, Vector3Add(Vector3Scale(side, cosf(angle) * off), Vector3Scale(up, sinf(angle) * off)));
         }
+        rays[p] = (Ray){ origin, Vector3Normalize(dir) };
     }
-    if(hit)
+    RayPacket packet = MakeRayPacket(rays, pellets, w->maxDist);
+    int laneGroups = (pellets + RAY_PACKET_LANES - 1) / RAY_PACKET_LANES;
+    // Step 2: Closest bad guy along every pellet, a nearer hit shrinks the pellet tMax so further bad guys drop out
+    int pelletBg[RAY_PACKET_MAX];
+    bool pelletBody[RAY_PACKET_MAX];
+    bool pelletHead[RAY_PACKET_MAX];
+    float tBox[RAY_PACKET_MAX], tBody[RAY_PACKET_MAX], tHead[RAY_PACKET_MAX];
+    int bgLanes = 0;
+    BoneObb obbs[BONE_HITBOX_MAX_BONES];
+    for (int i = 0; i < l->bgCount; i++)
     {
-        for(int i=0; i<l->objCount; i++)
+        if (l->bg[i].dead || l->bg[i].state == BG_STATE_DYING){continue;}
+        CountCollisionStat(STAT_SHOOT_RAY, STAT_RAY_BOX_TEST, laneGroups);
+        int boxMask = RayPacketBoxMask(&packet, packet.laneMask, GetBgShotBox(&l->bg[i]), tBox);
+        if(boxMask == 0){continue;}
+        if(l->bg[i].boneHits)//skinned, the posed bone boxes decide, only for the pellets that reached the enemy
         {
-            if(l->obj[i].useHitBoxes)
-            {
-                for(int j=0; j<l->obj[i].hitBoxCount; j++)
-                {
-                    RayCollision coll = GetRayCollisionBox(bulletRay, l->obj[i].hitBoxes[j]);
-                    if(coll.hit && coll.distance < minDistance){printf("hit obj hit-box, %d, %d\n", i, j);return;} 
-                }
-            }
-            else
+            const Enemy *bg = &l->bg[i];
+            const ModelAnimation *anim = bg->poseAnim >= 0 ? &bg->anims[bg->poseAnim] : NULL;
+            int obbCount = PoseBoneHitBoxes(bg->boneHits, anim, bg->poseFrame, bg->pos, bg->yaw, obbs);
+            for (int p = 0; p < pellets; p++)
             {
-                RayCollision coll = GetRayCollisionBox(bulletRay, l->obj[i].box);
-                if(coll.hit && coll.distance < minDistance){printf("hit wall %d\n", i);return;}
+                if(!(boxMask & (1 << p))){continue;}
+                float d;
+                CountCollisionStat(STAT_SHOOT_RAY, STAT_RAY_BOX_TEST, 1);
+                int hitBone = GetRayCollisionBoneHitBoxes(packet.rays[p], obbs, obbCount, packet.tMax[p], &d);
+                if(hitBone < 0){continue;}
+                packet.tMax[p] = d;
+                pelletBg[p] = i;
+                pelletBody[p] = true;
+                pelletHead[p] = obbs[hitBone].head;
+                bgLanes |= 1 << p;
             }
+            continue;
         }
-        printf("Bad guy %d hit!\n", minIndex);
-        if(bodyShot){printf("Bad guy %d Body Shot!\n", minIndex);points=10+minDistance;}
-        else if(!headShot){printf("Enemy %d grazed ... ?\n", minIndex);points=2;}
-        if(headShot){printf("Bad guy %d HEAD_SHOT, SNIPER!\n", minIndex);points=(10 * minDistance);}
-        float damn = bodyShot ? l->mc.weapons[l->mc.curWeaponIndex].damage : 2;
-        if(headShot && l->bg[minIndex].type==BG_TYPE_YETI){damn=50;}
-        l->bg[minIndex].health -= damn; // subtract hit
-        l->mc.score += ((int) points);
-        l->bg[minIndex].state = BG_STATE_HIT;
-        l->bg[minIndex].anim = l->bg[minIndex].type==BG_TYPE_ARMY?ANIM_HIT:ANIM_YETI_ROAR;
-        l->bg[minIndex].curFrame = l->bg[minIndex].type==BG_TYPE_ARMY?60:0; //hit anim is delayed with standing still, skip ahead unless yeti
-        if(l->bg[minIndex].health <= 0 || (l->bg[minIndex].type==BG_TYPE_ARMY && headShot))//bg is dead
+        CountCollisionStat(STAT_SHOOT_RAY, STAT_RAY_BOX_TEST, 2 * laneGroups);
+        int bodyMask = RayPacketBoxMask(&packet, boxMask, l->bg[i].bodyBox, tBody);
+        int headMask = RayPacketBoxMask(&packet, boxMask, l->bg[i].headBox, tHead);
+        for (int p = 0; p < pellets; p++)
         {
-            l->bg[minIndex].health = 0;
-            l->bg[minIndex].state = BG_STATE_DYING;
-            l->bg[minIndex].anim = l->bg[minIndex].type==BG_TYPE_ARMY?ANIM_DEATH:ANIM_YETI_ROAR;
-            l->bg[minIndex].curFrame = 0;
-            StartTimer(&l->bg[minIndex].t_yeti_death_wait);
-            printf("Bad guy %d dead!\n", minIndex);
-            if(!IsSoundPlaying(l->bg[minIndex].deathSound)){PlaySound(l->bg[minIndex].deathSound);}
-        }//mark if dying as needed
-        else //if hit but still alive
+            if(!(boxMask & (1 << p))){continue;}
+            packet.tMax[p] = tBox[p];
+            pelletBg[p] = i;
+            pelletBody[p] = bodyMask & (1 << p);
+            pelletHead[p] = headMask & (1 << p);
+            bgLanes |= 1 << p;
+        }
+    }
+    if(bgLanes == 0){return;}
+    // Step 3: Walls in front of the bad guys, only pellets that hit someone go through the world
+    float bgDist[RAY_PACKET_MAX];
+    memcpy(bgDist, packet.tMax, sizeof(bgDist));
+    RayHit walls[RAY_PACKET_MAX];
+    RaycastPacketClosest(&l->raycast, &packet, bgLanes, walls);
+    CountRaycastStats(l, STAT_SHOOT_RAY);
+    // Step 4: Sum the pellets per bad guy, each pellet carries its share of the weapon damage
+    // head pellets too, only the aimed center pellet in the head is the army guy head shot kill, like a single shot weapon
+    float share = 1.0f / pellets;
+    float bgDamage[MAX_BAD_GUYS] = {0};
+    float bgPoints[MAX_BAD_GUYS] = {0};
+    int bgPellets[MAX_BAD_GUYS] = {0};
+    bool bgHead[MAX_BAD_GUYS] = {0};
+    for (int p = 0; p < pellets; p++)
+    {
+        if(!(bgLanes & (1 << p))){continue;}
+        if(walls[p].hit)
         {
-            if(!IsSoundPlaying(l->bg[minIndex].hitSound)){PlaySound(l->bg[minIndex].hitSound);}
+            if(walls[p].hitBox >= 0){printf("hit obj hit-box, %d, %d\n", walls[p].obj, walls[p].hitBox);}
+            else{printf("hit wall %d\n", walls[p].obj);}
+            continue;
         }
+        int i = pelletBg[p];
+        float points = 0;
+        if(pelletBody[p]){points=10+bgDist[p];}
+        else if(!pelletHead[p]){points=2;}
+        if(pelletHead[p]){points=(10 * bgDist[p]);}
+        float damn = (pelletBody[p] || pelletHead[p]) ? w->damage : 2;
+        if(pelletHead[p] && l->bg[i].type==BG_TYPE_YETI){damn=50;}
+        bgDamage[i] += damn * share;
+        bgPoints[i] += points * share;
+        if(p == 0 && pelletHead[p]){bgHead[i] = true;}
+        bgPellets[i]++;
+    }
+    // Step 5: One hit per bad guy
+    for (int i = 0; i < l->bgCount; i++)
+    {
+        if(bgPellets[i] == 0){continue;}
+        printf("Bad guy %d hit by %d/%d pellets%s\n", i, bgPellets[i], pellets, bgHead[i] ? ", HEAD_SHOT, SNIPER!" : "!");
+        ApplyShotToBg(l, i, bgDamage[i], bgPoints[i], bgHead[i]);
     }
 }
 
@@ -245,33 +232,17 @@ void HandleBgShotPlayer(Level *l, GameState *gs, int enemyIndex)
     Vector3 origin = l->bg[enemyIndex].pos;
     Vector3 direction = Vector3Normalize(Vector3Subtract(l->mc.pos, l->bg[enemyIndex].pos));
     Ray bulletRay = (Ray){ origin, direction };
+    CountCollisionStat(STAT_BG_SHOT_PLAYER, STAT_RAY_BOX_TEST, 1);
     RayCollision mcColl = GetRayCollisionBox(bulletRay, l->mc.box);
     //report if its not a hit because that is strange
     if(!mcColl.hit){printf("HandleBgShotPlayer, no hit on MC?\n");}
     // step 2: check if collision hits walls instead
-    for(int i=0; i<l->objCount; i++)
+    bool blocked = RaycastAny(&l->raycast, bulletRay, mcColl.distance);
+    CountRaycastStats(l, STAT_BG_SHOT_PLAYER);
+    if(blocked)
     {
-        if(l->obj[i].useHitBoxes)
-        {
-            for(int j=0; j<l->obj[i].hitBoxCount; j++)
-            {
-                RayCollision coll = GetRayCollisionBox(bulletRay, l->obj[i].hitBoxes[j]);
-                if(coll.hit && coll.distance < mcColl.distance)
-                {
-                    //printf("bg %d hit obj hit-box, %d, %d\n", enemyIndex, i, j);
-                    return;
-                } 
-            }
-        }
-        else
-        {
-            RayCollision coll = GetRayCollisionBox(bulletRay, l->obj[i].box);
-            if(coll.hit && coll.distance < mcColl.distance)
-            {
-                //printf("bg %d hit wall %d\n", enemyIndex, i);
-                return;
-            }
-        }
+        //printf("bg %d shot hit a wall\n", enemyIndex);
+        return;
     }
     float damage = 5;
     int thresh = 3;
@@ -283,7 +254,8 @@ void HandleBgShotPlayer(Level *l, GameState *gs, int enemyIndex)
 void HandleBgState(Level *l, MainCharacter *mc, Enemy *bg, int index)
 {
     if(bg->dead){return;}
-    if(bg->state == BG_STATE_STILL && Vector3Distance(mc->pos, bg->pos) < BG_TO_MC_WAKE_UP_DIST)
+    //enemies in cells the player cannot see stay asleep
+    if(bg->state == BG_STATE_STILL && Vector3Distance(mc->pos, bg->pos) < BG_TO_MC_WAKE_UP_DIST && IsBoxInPvs(&l->pvs, l->pvsCell, bg->box))
     {
         bg->state = BG_STATE_PLANNING;
     }
@@ -324,14 +296,14 @@ void HandleBgState(Level *l, MainCharacter *mc, Enemy *bg, int index)
     else if(bg->state == BG_STATE_WALKING)
     {
         Vector3 direction = Vector3Subtract(bg->targetPos, bg->pos);
-        direction = Vector3Scale(Vector3Normalize(direction), bg->speed * GetFrameTime());
+        direction = Vector3Scale(Vector3Normalize(direction), bg->speed * GetGameFrameTime());
         bg->oldPos = bg->pos;
         bg->pos = Vector3Add(bg->pos, direction);
         bg->box = UpdateBoundingBox(bg->origBox,bg->pos);
         bg->bodyBox = UpdateBoundingBox(bg->origBodyBox,bg->pos);
         bg->headBox = UpdateBoundingBox(bg->origHeadBox,bg->pos);
         if(Vector3Distance(bg->pos, bg->targetPos) < BG_TO_TARGET_POS_ACCEPT
-            || HasTimerElapsed(&bg->t_walk_stuck,time(0)))
+            || HasTimerElapsed(&bg->t_walk_stuck,GetGameSeconds()))
         {
             ResetTimer(&bg->t_walk_stuck);
             if(BgLineOfSightToMc(l,bg,index))
@@ -349,9 +321,9 @@ void HandleBgState(Level *l, MainCharacter *mc, Enemy *bg, int index)
                     bg->jumpMove.y = 0; //we only want the x and z of the player to jump toward
                     //we need to update the y here so isJumping isnt immedialty set to false by collision
                     Vector3 m = Vector3Normalize(bg->jumpMove);
-                    m = Vector3Scale(m, bg->jumpSpeed * GetFrameTime());
+                    m = Vector3Scale(m, bg->jumpSpeed * GetGameFrameTime());
                     bg->pos = Vector3Add(bg->pos, m);
-                    bg->pos.y += bg->yVelocity * GetFrameTime();
+                    bg->pos.y += bg->yVelocity * GetGameFrameTime();
                     bg->yVelocity -= GRAVITY;
                     bg->box = UpdateBoundingBox(bg->origBox,bg->pos);
                     bg->bodyBox = UpdateBoundingBox(bg->origBodyBox,bg->pos);
@@ -374,9 +346,9 @@ void HandleBgState(Level *l, MainCharacter *mc, Enemy *bg, int index)
         {
             //printf("yeti is shooting ... \n");
             Vector3 m = Vector3Normalize(bg->jumpMove);
-            m = Vector3Scale(m, bg->jumpSpeed * GetFrameTime());
+            m = Vector3Scale(m, bg->jumpSpeed * GetGameFrameTime());
             bg->pos = Vector3Add(bg->pos, m);
-            bg->pos.y += bg->yVelocity * GetFrameTime();
+            bg->pos.y += bg->yVelocity * GetGameFrameTime();
             bg->yVelocity -= GRAVITY;
             if(bg->yVelocity < TERMINAL_Y_VEL) //if he fell to his death
             {
@@ -415,7 +387,7 @@ void HandleBgYetiAnimEnd(Enemy *bg,Level *l, GameState *gs)
 {
     if(bg->state == BG_STATE_DYING)
     {
-        if(bg->drawColor.a == 0 || HasTimerElapsed(&bg->t_yeti_death_wait,time(0)))//keep in sync with draw bg in draw game
+        if(bg->drawColor.a == 0 || HasTimerElapsed(&bg->t_yeti_death_wait,GetGameSeconds()))//keep in sync with draw bg in draw game
         {
             ResetTimer(&bg->t_yeti_death_wait);//not really needed but sure why not
             bg->state = BG_STATE_DEAD;
@@ -516,6 +488,49 @@ bool IsBoxInFrustum(BoundingBox box, Frustum frustum)
     return true;
 }
 
+//one brush waiting to be drawn into the occlusion buffer
+typedef struct {
+    int index;
+    float dist;
+} OccluderPick;
+
+static int CompareOccluderPicks(const void *a, const void *b)
+{
+    float da = ((const OccluderPick *)a)->dist;
+    float db = ((const OccluderPick *)b)->dist;
+    return da < db ? -1 : (da > db ? 1 : 0);
+}
+
+//draws the nearest big visible brushes into gs->occlusion for the camera the next draw uses
+void RenderOccluders(GameState *gs, Level *l)
+{
+    Matrix view = MatrixLookAt(l->mc.camera.position, l->mc.camera.target, l->mc.camera.up);
+    Matrix proj = MatrixPerspective(DEG2RAD * l->mc.camera.fovy, SCREEN_WIDTH / (float)SCREEN_HEIGHT, 0.1f, 100.0f);
+    Matrix vp = MatrixMultiply(view, proj);
+    Frustum frustum = ExtractFrustum(vp);
+    BeginOcclusionFrame(&gs->occlusion, vp);
+    OccluderPick picks[MAX_ENV_OBJECTS];
+    int pickCount = 0;
+    for(int i = 0; i < l->objCount; i++)
+    {
+        const EnvObject *o = &l->obj[i];
+        if(o->pointEntity || !o->pvsVisible || o->colMesh.triCount == 0){continue;}
+        Vector3 size = Vector3Subtract(o->box.max, o->box.min);
+        if(fmaxf(size.x, fmaxf(size.y, size.z)) < OCCLUSION_MIN_SIZE){continue;}
+        Vector3 closest = Vector3Clamp(l->mc.camera.position, o->box.min, o->box.max);
+        float dist = Vector3Distance(closest, l->mc.camera.position);
+        if(dist > OCCLUSION_OCCLUDER_DIST || !IsBoxInFrustum(o->box, frustum)){continue;}
+        picks[pickCount++] = (OccluderPick){ i, dist };
+    }
+    qsort(picks, pickCount, sizeof(OccluderPick), CompareOccluderPicks);
+    if(pickCount > OCCLUSION_MAX_OCCLUDERS){pickCount = OCCLUSION_MAX_OCCLUDERS;}
+    for(int i = 0; i < pickCount; i++)
+    {
+        const CollisionMesh *cm = &l->obj[picks[i].index].colMesh;
+        DrawOccluderTris(&gs->occlusion, cm->tris, cm->triCount);
+    }
+}
+
 void DrawCustomFPS(int x, int y, Color color)
 {
     int fps = GetFPS();
@@ -545,47 +560,4 @@ void DrawHeart(Vector2 position, float size, Color color)
     DrawTriangle(p1, p2, p3, color);
 }
 
-//returns true if bg has line of sight to mc
-bool BgLineOfSightToMc(Level *l, Enemy *bg, int index)
-{
-    // Step 1: Create a ray from the camera and detect collision (should always hit)
-    Vector3 origin = bg->pos;
-    Vector3 direction = Vector3Normalize(Vector3Subtract(l->mc.pos, bg->pos));
-    Vector3 direction2 = Vector3Normalize(Vector3Subtract(l->mc.camera.position, bg->pos));
-    Ray bulletRay = (Ray){ origin, direction };
-    Ray bulletRay2 = (Ray){ origin, direction2 };
-    RayCollision mcColl = GetRayCollisionBox(bulletRay, l->mc.box);
-    //report if its not a hit because that is strange
-    if(!mcColl.hit){printf("BgLineOfSightToMc, no hit on MC?\n");}
-    // step 2: check if collision hits walls instead
-    for(int i=0; i<l->objCount; i++)
-    {
-        if(l->obj[i].useHitBoxes)
-        {
-            for(int j=0; j<l->obj[i].hitBoxCount; j++)
-            {
-                RayCollision coll = GetRayCollisionBox(bulletRay, l->obj[i].hitBoxes[j]);
-                RayCollision coll2 = GetRayCollisionBox(bulletRay2, l->obj[i].hitBoxes[j]);
-                if(coll.hit && coll.distance < mcColl.distance && coll2.hit && coll2.distance < mcColl.distance)
-                {
-                    //printf("bg cant see mc because of BB\n");
-                    return false;
-                } 
-            }
-        }
-        else
-        {
-            RayCollision coll = GetRayCollisionBox(bulletRay, l->obj[i].box);
-            RayCollision coll2 = GetRayCollisionBox(bulletRay2, l->obj[i].box);
-            if(coll.hit && coll.distance < mcColl.distance && coll2.hit && coll2.distance < mcColl.distance)
-            {
-                //printf("bg cant see mc because of wall\n");
-                return false;
-            }
-        }
-    }
-    //printf("bg %d can see mc\n",index);
-    return true;
-}
-
 
@@ -17,9 +17,6 @@ typedef struct Frustum {
 } Frustum;
 
 //functions
-void DrawTriangles(Model *m, bool useOrigin, Vector3 origin);
-void DrawTrianglesIndexed(Model *m, bool useOrigin, Vector3 origin);
-bool IsModelIndexed(Model *m);
 void DrawHealthBar(Vector2 position, float width, float height, float healthPercent);
 void DrawCrosshair();
 void DrawGunHeld(Model gunModel, Camera camera, Vector3 gunPos, float rot);
@@ -34,8 +31,8 @@ void HandleBgYetiAnimEnd(Enemy *bg,Level *l, GameState *gs);
 bool IsWithinDistance(Vector3 a, Vector3 b, float maxDist);
 Frustum ExtractFrustum(Matrix mat);
 bool IsBoxInFrustum(BoundingBox box, Frustum frustum);
+void RenderOccluders(GameState *gs, Level *l);
 void DrawCustomFPS(int x, int y, Color color);
 void DrawHeart(Vector2 position, float size, Color color);
-bool BgLineOfSightToMc(Level *l, Enemy *bg, int index);
 
 #endif // FUNCTIONS_H
\ No newline at end of file
@@ -2,6 +2,8 @@
 #include "game.h"
 #include "collision.h"
 #include "functions.h"
+#include "collision_stats.h"
+#include "los.h"
 #include "timer.h"
 #include "raylib.h"
 #include "raymath.h"
@@ -13,10 +15,10 @@
 
 void LoadGameStateSounds(GameState *gs)
 {
-    gs->selectSound=LoadSound("sounds/select.mp3");
-    gs->enterSound=LoadSound("sounds/enter.mp3");
-    gs->playSound=LoadSound("sounds/play.mp3");
-    gs->music = LoadMusicStream("sounds/game_music.mp3");
+    gs->selectSound=LoadSoundIfAudio("sounds/select.mp3");
+    gs->enterSound=LoadSoundIfAudio("sounds/enter.mp3");
+    gs->playSound=LoadSoundIfAudio("sounds/play.mp3");
+    gs->music = IsAudioDeviceReady() ? LoadMusicStream("sounds/game_music.mp3") : (Music){0};
 }
 void UnloadGameStateSounds(GameState *gs)
 {
@@ -202,8 +204,8 @@ void UpdateInGameMenu(GameState *gs, Level *l)
 
 void UpdateGame(GameState *gs, Level *l)
 {
-    float dt = GetFrameTime();
-    time_t currentTime = time(NULL);
+    float dt = GetGameFrameTime();
+    time_t currentTime = GetGameSeconds();
 
     //reset gs timers - handle reset of basic timers
     if(HasTimerElapsed(&gs->t_crouch_wait,currentTime))
@@ -239,6 +241,22 @@ void UpdateGame(GameState *gs, Level *l)
         0.0f,
         cosf(l->mc.yaw - PI/2.0f)
     };
+    //env object pvs flags only change when the camera crosses into another cell
+    int pvsCell = GetPvsCell(&l->pvs, l->mc.camera.position);
+    if(pvsCell != l->pvsCell)
+    {
+        l->pvsCell = pvsCell;
+        for(int i=0; i<l->objCount; i++)
+        {
+            l->obj[i].pvsVisible = IsBoxInPvs(&l->pvs, pvsCell, l->obj[i].box);
+        }
+        for(int i=0; i<l->batchCount; i++)
+        {
+            l->batches[i].pvsVisible = IsBoxInPvs(&l->pvs, pvsCell, l->batches[i].box);
+        }
+    }
+    //refresh stale line of sight answers in one batch before the bg states ask for them
+    UpdateLosService(l);
     //update bg states and movement and such
     for(int i=0; i<l->bgCount; i++)
     {
@@ -267,6 +285,8 @@ void UpdateGame(GameState *gs, Level *l)
     if (IsKeyDown(KEY_P)) {printf("position: %f %f %f\n", l->mc.pos.x,l->mc.pos.y,l->mc.pos.z);}
     if (IsKeyDown(KEY_B)) {gs->showBoxes = !gs->showBoxes;}
     if (IsKeyDown(KEY_T)) {gs->drawTri = !gs->drawTri;}
+    if (IsKeyPressed(KEY_H)) {gs->showCollisionHeat = !gs->showCollisionHeat;} //tint env objects by collision cost
+    if (IsKeyPressed(KEY_J)) {ToggleCollisionStatsCsv();} //start/stop the per frame collision csv
     if (IsKeyDown(KEY_LEFT_CONTROL) && !l->mc.isJumping && !gs->t_crouch_wait.wasStarted)
     {
         l->mc.isCrouching = !l->mc.isCrouching;
@@ -321,11 +341,19 @@ void UpdateGame(GameState *gs, Level *l)
     //------------------------------------------------------------------------------------------------
     //env objects and mc, before we detect collisions, we need to set platform to false;
     l->mc.isOnPlatform = false;
-    for(int i=0; i<l->objCount; i++)
+    //resolving one object can push the mc a little, so ask the grid with some slack
+    BoundingBox mcQuery = l->mc.box;
+    mcQuery.min = Vector3SubtractValue(mcQuery.min, MC_GRID_QUERY_PAD);
+    mcQuery.max = Vector3AddValue(mcQuery.max, MC_GRID_QUERY_PAD);
+    int nearObj[MAX_ENV_OBJECTS];
+    int nearCount = QueryWorldGrid(&l->grid, mcQuery, nearObj, MAX_ENV_OBJECTS);
+    for(int n=0; n<nearCount; n++)
     {
+        int i = nearObj[n];
         if(l->obj[i].noCOll){continue;}
         // if(Vector3Distance(l->mc.pos, l->obj[i].pos) < l->obj[i].radius + 2.2f 
         //     || CheckCollisionBoxes(l->mc.box, l->obj[i].box))
+        CountObjectCollisionStat(STAT_OBJECT_COLLISION, STAT_AABB_TEST, &l->obj[i], 1);
         if(CheckCollisionBoxes(l->mc.box, l->obj[i].box))
         {
             //printf("HandleObjectCollision: i=%d\n",i);
@@ -365,34 +393,6 @@ void UpdateGame(GameState *gs, Level *l)
         //printf("falling...\n");
         l->mc.isFalling = true;
     }
-    //-----------BADGUY ANIMS------------------------------------------------------------------------
-    for(int i=0; i<l->bgCount; i++)
-    {
-        if(l->bg[i].state == BG_STATE_STILL || l->bg[i].state == BG_STATE_PLANNING){continue;}
-        //get frustum
-        Matrix view = MatrixLookAt(l->mc.camera.position, l->mc.camera.target, l->mc.camera.up);
-        Matrix proj = MatrixPerspective(DEG2RAD * l->mc.camera.fovy, SCREEN_WIDTH / (float)SCREEN_HEIGHT, 0.1f, 100.0f);
-        Matrix vp = MatrixMultiply(view, proj);
-        Frustum frustum = ExtractFrustum(vp);
-        if(IsWithinDistance(l->bg[i].pos,l->mc.pos,100)&&IsBoxInFrustum(l->bg[i].box, frustum))
-        {
-            UpdateModelAnimation(l->bg[i].model, l->bg[i].anims[l->bg[i].anim], l->bg[i].curFrame);
-        }
-        l->bg[i].curFrame++;
-        if(l->bg[i].type==BG_TYPE_ARMY && l->bg[i].state == BG_STATE_DYING){l->bg[i].pos.y += dt;}//this anim sinks too much into the ground
-        if (l->bg[i].curFrame >= l->bg[i].anims[l->bg[i].anim].frameCount) 
-        {
-            l->bg[i].curFrame = 0;
-            if(l->bg[i].type == BG_TYPE_ARMY){HandleBgArmyAnimEnd(&l->bg[i],l,gs,i);}
-            else if (l->bg[i].type == BG_TYPE_YETI){HandleBgYetiAnimEnd(&l->bg[i],l,gs);}
-        }
-        if(l->bg[i].type==BG_TYPE_ARMY && l->bg[i].anim==ANIM_SHOOT && l->bg[i].curFrame==25)// && !IsSoundPlaying(l->bg[i].shootSound))
-        {
-            //printf("bg army shot sound coming from %d %s\n",i,l->bg[i].isShooter?"shooter":"walker");
-            PlaySound(l->bg[i].shootSound);
-        }
-    }
-    //-----------END BADGUY ANIMS--------------------------------------------------------------------
     //handle death
     if(DEAD_ZONE > l->mc.pos.y || l->mc.health <= 0)
     {
@@ -404,83 +404,172 @@ void UpdateGame(GameState *gs, Level *l)
         l->mc.isFalling = false;
         PlaySound(l->mc.deathSound);
     }
-    //update camera before draw
+    //update camera before the anims and the draw
     l->mc.camera.position = (Vector3){
         l->mc.pos.x, 
         l->mc.isCrouching ? l->mc.pos.y + l->mc.crouchHeight : l->mc.pos.y + l->mc.height, 
         l->mc.pos.z};
     l->mc.camera.target = Vector3Add(l->mc.camera.position, forward);
+    //brushes for this camera, the animation lod below and the draw test against them, so nothing is culled with last frame's view
+    RenderOccluders(gs, l);
+    //-----------BADGUY ANIMS------------------------------------------------------------------------
+    //clips play by time, the pose on screen is refreshed less often the further away it is
+    Matrix animView = MatrixLookAt(l->mc.camera.position, l->mc.camera.target, l->mc.camera.up);
+    Matrix animProj = MatrixPerspective(DEG2RAD * l->mc.camera.fovy, SCREEN_WIDTH / (float)SCREEN_HEIGHT, 0.1f, 100.0f);
+    Frustum animFrustum = ExtractFrustum(MatrixMultiply(animView, animProj));
+    for(int i=0; i<l->bgCount; i++)
+    {
+        if(l->bg[i].state == BG_STATE_STILL || l->bg[i].state == BG_STATE_PLANNING){continue;}
+        //advance one keyframe at a time so the frame 25 shot and the anim end handlers see every keyframe
+        l->bg[i].frameTime += dt * ANIM_FRAME_RATE;
+        for(int step = 0; l->bg[i].frameTime >= 1.0f; step++)
+        {
+            if(step == ANIM_MAX_STEPS){l->bg[i].frameTime = 0.0f; break;}
+            l->bg[i].frameTime -= 1.0f;
+            l->bg[i].curFrame++;
+            if (l->bg[i].curFrame >= l->bg[i].anims[l->bg[i].anim].frameCount) 
+            {
+                l->bg[i].curFrame = 0;
+                if(l->bg[i].type == BG_TYPE_ARMY){HandleBgArmyAnimEnd(&l->bg[i],l,gs,i);}
+                else if (l->bg[i].type == BG_TYPE_YETI){HandleBgYetiAnimEnd(&l->bg[i],l,gs);}
+            }
+            if(l->bg[i].type==BG_TYPE_ARMY && l->bg[i].anim==ANIM_SHOOT && l->bg[i].curFrame==25)// && !IsSoundPlaying(l->bg[i].shootSound))
+            {
+                //printf("bg army shot sound coming from %d %s\n",i,l->bg[i].isShooter?"shooter":"walker");
+                PlaySound(l->bg[i].shootSound);
+            }
+            if(l->bg[i].state == BG_STATE_STILL || l->bg[i].state == BG_STATE_PLANNING){l->bg[i].frameTime = 0.0f; break;}//an end handler parked it
+        }
+        if(l->bg[i].type==BG_TYPE_ARMY && l->bg[i].state == BG_STATE_DYING){l->bg[i].pos.y += dt;}//this anim sinks too much into the ground
+        //animation lod, full rate close by, then every 2nd and 4th keyframe, frozen far away or off screen
+        l->bg[i].poseAge += dt;
+        float dist = Vector3Distance(l->bg[i].pos, l->mc.pos);
+        if(dist > ANIM_LOD_MAX_DIST || !IsBoxInFrustum(l->bg[i].box, animFrustum) || IsBoxOccluded(&gs->occlusion, l->bg[i].box)){continue;}
+        float interval = dist < ANIM_LOD_FULL_DIST ? 0.0f : (dist < ANIM_LOD_HALF_DIST ? 2.0f : 4.0f) / ANIM_FRAME_RATE;
+        if(l->bg[i].poseAnim >= 0 && l->bg[i].poseAge < interval){continue;}
+        l->bg[i].poseAge = 0.0f;
+        //queue the frame for the job pool at the mesh lod for this distance, the model is shared so it is never posed in place
+        l->bg[i].poseLod = PickMeshLod(dist);
+        if(l->bg[i].skin){RequestSkinnedMeshes(l->bg[i].skin + l->bg[i].poseLod, l->bg[i].anim, l->bg[i].curFrame, l->bg[i].frameTime);}
+        //shot boxes follow the pose that is on screen
+        l->bg[i].poseAnim = l->bg[i].anim;
+        l->bg[i].poseFrame = l->bg[i].curFrame;
+        l->bg[i].poseBlend = l->bg[i].frameTime;
+        if(l->bg[i].boneHits){l->bg[i].poseBox = GetBonePoseBounds(l->bg[i].boneHits, &l->bg[i].anims[l->bg[i].anim], l->bg[i].curFrame);}
+    }
+    RunSkinJobs(); //every frame queued above, skinned across the job pool before the draw uses them
+    //-----------END BADGUY ANIMS--------------------------------------------------------------------
+    EndCollisionStatsFrame(l);
 }
 
-void DrawGame(GameState *gs, Level *l)
+//culls the level for the camera and queues the models to draw, debug wireframes and boxes draw right away
+//also fades dying enemies, headless runs call it without a draw to keep that going, returns the dead enemy count
+int QueueGameScene(GameState *gs, Level *l)
 {
-    BeginDrawing();
-        ClearBackground(SKYBLUE);
-        BeginMode3D(l->mc.camera);
-            //get frustum
-            Matrix view = MatrixLookAt(l->mc.camera.position, l->mc.camera.target, l->mc.camera.up);
-            Matrix proj = MatrixPerspective(DEG2RAD * l->mc.camera.fovy, SCREEN_WIDTH / (float)SCREEN_HEIGHT, 0.1f, 100.0f);
-            Matrix vp = MatrixMultiply(view, proj);
-            Frustum frustum = ExtractFrustum(vp);
+    //get frustum
+    Matrix view = MatrixLookAt(l->mc.camera.position, l->mc.camera.target, l->mc.camera.up);
+    Matrix proj = MatrixPerspective(DEG2RAD * l->mc.camera.fovy, SCREEN_WIDTH / (float)SCREEN_HEIGHT, 0.1f, 100.0f);
+    Matrix vp = MatrixMultiply(view, proj);
+    Frustum frustum = ExtractFrustum(vp);
+    Vector3 eye = l->mc.camera.position;
+    BeginRenderQueue(&gs->queue);
 
-            //draw static props / env objects
-            for (int i = 0; i < l->objCount; i++)
+    //draw static batches, one call per texture and chunk, the debug views tint or split single brushes so they skip this
+    bool useBatches = !gs->drawTri && !gs->showCollisionHeat;
+    if(useBatches)
+    {
+        for (int i = 0; i < l->batchCount; i++)
+        {
+            if(!l->batches[i].pvsVisible||!IsBoxInFrustum(l->batches[i].box, frustum)){continue;}
+            float depth = Vector3Distance(eye, Vector3Clamp(eye, l->batches[i].box.min, l->batches[i].box.max));//nearest point, the eye is often inside a chunk
+            SubmitRenderItem(&gs->queue, RENDER_PASS_OPAQUE, l->batches[i].model, (Vector3){0}, 0, WHITE, depth);
+        }
+    }
+    //draw static props / env objects
+    for (int i = 0; i < l->objCount; i++)
+    {
+        if(!l->obj[i].pvsVisible||!IsWithinDistance(l->obj[i].pos,l->mc.pos,200)||!IsBoxInFrustum(l->obj[i].box, frustum)){continue;}
+        if(l->obj[i].pointEntity && IsBoxOccluded(&gs->occlusion, l->obj[i].box)){continue;}//brushes are the occluders, only props are tested
+        if(gs->drawTri){DrawWireframeModel(&l->wire, l->obj[i].model, l->obj[i].useOrigin?l->obj[i].origin:(Vector3){0}, RED);}
+        else if(useBatches && l->obj[i].pointEntity)//trees share models, and a simpler one further away
+        {
+            Model m = l->obj[i].lods >= 0 ? GetModelLod(&l->modelLods[l->obj[i].lods], Vector3Distance(l->obj[i].pos, l->mc.pos)) : l->obj[i].model;
+            Vector3 pos = l->obj[i].useOrigin?l->obj[i].origin:(Vector3){0};
+            if(!AddInstance(&gs->instances, m, pos))//too many shared models this frame, sorted with the rest instead
             {
-                if(!IsWithinDistance(l->obj[i].pos,l->mc.pos,200)||!IsBoxInFrustum(l->obj[i].box, frustum)){continue;}
-                if(gs->drawTri)
-                {
-                    if(IsModelIndexed(&l->obj[i].model)){DrawTrianglesIndexed(&l->obj[i].model,l->obj[i].useOrigin,l->obj[i].origin);}
-                    else{DrawTriangles(&l->obj[i].model,l->obj[i].useOrigin,l->obj[i].origin);}
-                }
-                else {DrawModel(l->obj[i].model, l->obj[i].useOrigin?l->obj[i].origin:(Vector3){0} , 1.0f, WHITE);}
-                if(gs->showBoxes){DrawBoundingBox(l->obj[i].box, YELLOW);}
-                if(gs->showBoxes && l->obj[i].useHitBoxes)
-                {
-                    for(int j=0; j<l->obj[i].hitBoxCount; j++)
-                    {
-                        DrawBoundingBox(l->obj[i].hitBoxes[j], DARKBLUE);
-                    }
-                }
+                SubmitRenderItem(&gs->queue, RENDER_PASS_OPAQUE, m, pos, 0, WHITE, Vector3Distance(eye, Vector3Clamp(eye, l->obj[i].box.min, l->obj[i].box.max)));
             }
-            //draw bad guys
-            int deadBgCount = 0;
-            for (int i = 0; i < l->bgCount; i++)
+        }
+        else if(!useBatches || l->obj[i].batch < 0)
+        {
+            float depth = Vector3Distance(eye, Vector3Clamp(eye, l->obj[i].box.min, l->obj[i].box.max));
+            SubmitRenderItem(&gs->queue, RENDER_PASS_OPAQUE, l->obj[i].model, l->obj[i].useOrigin?l->obj[i].origin:(Vector3){0}, 0, gs->showCollisionHeat?GetCollisionHeatColor(&l->obj[i]):WHITE, depth);
+        }
+        if(gs->showBoxes){DrawBoundingBox(l->obj[i].box, YELLOW);}
+        if(gs->showBoxes && l->obj[i].useHitBoxes)
+        {
+            for(int j=0; j<l->obj[i].hitBoxCount; j++)
             {
-                if(l->bg[i].dead){deadBgCount++; continue;}
-                if(!IsWithinDistance(l->bg[i].pos,l->mc.pos,100)||!IsBoxInFrustum(l->bg[i].box, frustum)){continue;}
-                if(gs->drawTri)
-                {
-                    if(IsModelIndexed(&l->bg[i].model)){DrawTrianglesIndexed(&l->bg[i].model,true,l->bg[i].pos);}
-                    else{DrawTriangles(&l->bg[i].model,true,l->bg[i].pos);}
-                }
-                else
-                {
-                    if(l->bg[i].state == BG_STATE_DYING && l->bg[i].drawColor.a != 0)//keep in sync with yeti anim end for dying
-                    {
-                        l->bg[i].drawColor.a -= 1;
-                    }//I like this fade out
-                    DrawModelEx(l->bg[i].model, l->bg[i].pos,(Vector3){0,1,0}, RAD2DEG*l->bg[i].yaw, (Vector3){1,1,1}, l->bg[i].drawColor);
-                }
-                if(gs->showBoxes)
-                {
-                    DrawBoundingBox(l->bg[i].box, VIOLET);
-                    DrawBoundingBox(l->bg[i].bodyBox, PURPLE);
-                    DrawBoundingBox(l->bg[i].headBox, RED);
-                }
+                DrawBoundingBox(l->obj[i].hitBoxes[j], DARKBLUE);
             }
-            //draw items
-            for (int i = 0; i < l->itemCount; i++)
+        }
+    }
+    //draw bad guys
+    int deadBgCount = 0;
+    for (int i = 0; i < l->bgCount; i++)
+    {
+        if(l->bg[i].dead){deadBgCount++; continue;}
+        if(!IsBoxInPvs(&l->pvs,l->pvsCell,l->bg[i].box)||!IsWithinDistance(l->bg[i].pos,l->mc.pos,100)||!IsBoxInFrustum(l->bg[i].box, frustum)||IsBoxOccluded(&gs->occlusion, l->bg[i].box)){continue;}
+        //same model, but with the shared skinned meshes of its current frame
+        Model bgModel = l->bg[i].model;
+        if(l->bg[i].skin && l->bg[i].poseAnim >= 0)
+        {
+            Mesh *skinned = GetSkinnedMeshes(l->bg[i].skin + l->bg[i].poseLod, l->bg[i].poseAnim, l->bg[i].poseFrame, l->bg[i].poseBlend);
+            if(skinned){bgModel.meshes = skinned;}
+        }
+        if(gs->drawTri){DrawWireframeModel(&l->wire, bgModel, l->bg[i].pos, RED);}//skinned frames are shared, enemies on the same pose draw the same buffer
+        else
+        {
+            if(l->bg[i].state == BG_STATE_DYING && l->bg[i].drawColor.a != 0)//keep in sync with yeti anim end for dying
             {
-                if(l->items[i].isCollected){continue;}
-                if(!IsWithinDistance(l->items[i].pos,l->mc.pos,150)||!IsBoxInFrustum(l->items[i].box, frustum)){continue;}
-                if(gs->drawTri)
-                {
-                    if(IsModelIndexed(&l->items[i].model)){DrawTrianglesIndexed(&l->items[i].model,true,l->items[i].pos);}
-                    else{DrawTriangles(&l->items[i].model,true,l->items[i].pos);}
-                }
-                else{DrawModel(l->items[i].model, l->items[i].pos, 1.0f, WHITE);}
-                if(gs->showBoxes){DrawBoundingBox(l->items[i].box, PINK);}
-            }
+                l->bg[i].drawColor.a -= 1;
+            }//I like this fade out
+            RenderPass pass = l->bg[i].drawColor.a < 255 ? RENDER_PASS_FADING : RENDER_PASS_OPAQUE;
+            SubmitRenderItem(&gs->queue, pass, bgModel, l->bg[i].pos, RAD2DEG*l->bg[i].yaw, l->bg[i].drawColor, Vector3Distance(eye, l->bg[i].pos));
+        }
+        if(gs->showBoxes)
+        {
+            DrawBoundingBox(l->bg[i].box, VIOLET);
+            DrawBoundingBox(l->bg[i].bodyBox, PURPLE);
+            DrawBoundingBox(l->bg[i].headBox, RED);
+        }
+    }
+    //draw items
+    for (int i = 0; i < l->itemCount; i++)
+    {
+        if(l->items[i].isCollected){continue;}
+        if(!IsBoxInPvs(&l->pvs,l->pvsCell,l->items[i].box)||!IsWithinDistance(l->items[i].pos,l->mc.pos,150)||!IsBoxInFrustum(l->items[i].box, frustum)||IsBoxOccluded(&gs->occlusion, l->items[i].box)){continue;}
+        if(gs->drawTri){DrawWireframeModel(&l->wire, l->items[i].model, l->items[i].pos, RED);}
+        else if(!AddInstance(&gs->instances, l->items[i].model, l->items[i].pos))
+        {
+            SubmitRenderItem(&gs->queue, RENDER_PASS_OPAQUE, l->items[i].model, l->items[i].pos, 0, WHITE, Vector3Distance(eye, l->items[i].pos));
+        }
+        if(gs->showBoxes){DrawBoundingBox(l->items[i].box, PINK);}
+    }
+    return deadBgCount;
+}
+
+void DrawGame(GameState *gs, Level *l)
+{
+    BeginDrawing();
+        ClearBackground(SKYBLUE);
+        BeginMode3D(l->mc.camera);
+            int deadBgCount = QueueGameScene(gs, l);
+            //opaque models by texture, then the instanced props, then whatever is fading out over all of them
+            SortRenderQueue(&gs->queue);
+            DrawRenderQueuePass(&gs->queue, RENDER_PASS_OPAQUE);
+            FlushInstances(&gs->instances);//one instanced call per mesh of every shared prop model queued above
+            DrawRenderQueuePass(&gs->queue, RENDER_PASS_FADING);
             //draw mc stuff
             if(gs->showBoxes){DrawBoundingBox(l->mc.box, BLUE);}
         EndMode3D();
@@ -511,7 +600,7 @@ void DrawGame(GameState *gs, Level *l)
             {
                 StartTimer(&gs->t_endLevel_wait);
             }
-            else if(HasTimerElapsed(&gs->t_endLevel_wait, time(0)))
+            else if(HasTimerElapsed(&gs->t_endLevel_wait, GetGameSeconds()))
             {
                 gs->screen=SCREEN_MENU;
                 ResetTimer(&gs->t_endLevel_wait);
@@ -527,7 +616,7 @@ void DrawGame(GameState *gs, Level *l)
                 StartTimer(&gs->t_endLevel_wait);
                 PlaySound(l->mc.looseSound);
             }
-            else if(HasTimerElapsed(&gs->t_endLevel_wait, time(0)))
+            else if(HasTimerElapsed(&gs->t_endLevel_wait, GetGameSeconds()))
             {
                 gs->screen=SCREEN_MENU;
                 ResetTimer(&gs->t_endLevel_wait);
@@ -4,10 +4,14 @@
 #include "raylib.h"
 #include "level.h"
 #include "timer.h"
+#include "instancing.h"
+#include "occlusion.h"
+#include "render_queue.h"
 
 //constants
 #define SCREEN_WIDTH 800
 #define SCREEN_HEIGHT 600
+#define MC_GRID_QUERY_PAD 1.0f //meters added around the mc box when asking the world grid for nearby objects
 
 //enums
 typedef enum {
@@ -38,6 +42,7 @@ typedef struct {
     bool invertY;
     bool showBoxes;
     bool drawTri;
+    bool showCollisionHeat;
     bool quickFire;
     bool playMusic;
     int menuSelection;
@@ -56,10 +61,14 @@ typedef struct {
     Sound enterSound;
     Sound playSound;
     Music music;
+    InstanceRenderer instances; //shared prop models drawn instanced, see instancing.c
+    OcclusionBuffer occlusion; //brush depth of the last update, hides enemies, items and props behind walls
+    RenderQueue queue; //model draws of the frame, sorted by texture and depth, see render_queue.c
 } GameState;
 
 //functions
 void UpdateGame(GameState *gs, Level *l);
+int QueueGameScene(GameState *gs, Level *l);
 void DrawGame(GameState *gs, Level *l);
 void UpdateMainMenu(GameState *gs);
 void UpdateOptionsMenu(GameState *gs, Level *l);
@@ -0,0 +1,73 @@
+#include "ground_field.h"
+#include "raylib.h"
+#include "raymath.h"
+#include <stdio.h>
+#include <math.h>
+
+//meshes[i] is the collision mesh of env object i, NULL for objects without one
+GroundField BuildGroundField(const CollisionMesh **meshes, int count)
+{
+    GroundField f = {0};
+    for(int i = 0; i < count; i++)
+    {
+        if(!meshes[i]){continue;}
+        for(int t = 0; t < meshes[i]->triCount; t++)
+        {
+            if(meshes[i]->tris[t].normal.y > GROUND_MIN_DOT_UP){f.surfaceCount++;}
+        }
+    }
+    if(f.surfaceCount == 0){return f;}
+
+    f.surfaces = MemAlloc(sizeof(GroundSurface) * f.surfaceCount);
+    BoundingBox *boxes = MemAlloc(sizeof(BoundingBox) * f.surfaceCount);
+    int s = 0;
+    for(int i = 0; i < count; i++)
+    {
+        if(!meshes[i]){continue;}
+        for(int t = 0; t < meshes[i]->triCount; t++)
+        {
+            const CollisionTri *tri = &meshes[i]->tris[t];
+            if(tri->normal.y <= GROUND_MIN_DOT_UP){continue;}
+            //solve the plane for y, normal.y is well away from zero here
+            f.surfaces[s].a = -tri->normal.x / tri->normal.y;
+            f.surfaces[s].b = -tri->normal.z / tri->normal.y;
+            f.surfaces[s].c = -tri->planeD / tri->normal.y;
+            f.surfaces[s].obj = i;
+            boxes[s].min = Vector3Min(tri->v0, Vector3Min(tri->v1, tri->v2));
+            boxes[s].max = Vector3Max(tri->v0, Vector3Max(tri->v1, tri->v2));
+            s++;
+        }
+    }
+    f.grid = BuildWorldGrid(boxes, f.surfaceCount, GROUND_FIELD_CELL_SIZE);
+    MemFree(boxes);
+    printf("ground field: %d walkable surfaces\n", f.surfaceCount);
+    return f;
+}
+
+//highest walkable surface under pos with a height in [minY, maxY], only surfaces whose bounds touch box count
+//obj limits the answer to one env object, -1 for any
+bool GetGroundHeight(GroundField *f, BoundingBox box, Vector3 pos, float minY, float maxY, int obj, float *outY)
+{
+    int near[GROUND_QUERY_MAX];
+    int nearCount = QueryWorldGrid(&f->grid, box, near, GROUND_QUERY_MAX);
+    bool found = false;
+    float best = -INFINITY;
+    for(int n = 0; n < nearCount; n++)
+    {
+        const GroundSurface *g = &f->surfaces[near[n]];
+        if(obj >= 0 && g->obj != obj){continue;}
+        float y = g->a * pos.x + g->b * pos.z + g->c;
+        if(y < minY || y > maxY || y <= best){continue;}
+        best = y;
+        found = true;
+    }
+    if(found){*outY = best;}
+    return found;
+}
+
+void UnloadGroundField(GroundField *f)
+{
+    UnloadWorldGrid(&f->grid);
+    if(f->surfaces){MemFree(f->surfaces);}
+    *f = (GroundField){0};
+}
@@ -0,0 +1,34 @@
+#ifndef GROUND_FIELD_H
+#define GROUND_FIELD_H
+
+#include "raylib.h"
+#include "broadphase.h"
+#include "collision_mesh.h"
+
+//constants
+#define GROUND_FIELD_CELL_SIZE 2.0f //meters, small enough that a cell only holds a handful of floor pieces
+#define GROUND_MIN_DOT_UP 0.7f //same walkable test the collision code uses
+#define GROUND_QUERY_MAX 256 //surfaces looked at per query
+
+//structs
+//one walkable triangle reduced to its plane, y = a * x + b * z + c
+typedef struct {
+    float a;
+    float b;
+    float c;
+    int obj; //env object the triangle came from
+} GroundSurface;
+
+//every walkable surface of the level in an x/z grid, cells keep all layers so stacked floors each get an entry
+typedef struct {
+    WorldGrid grid; //item i is surfaces[i], boxed by its triangle bounds
+    GroundSurface *surfaces;
+    int surfaceCount;
+} GroundField;
+
+//functions
+GroundField BuildGroundField(const CollisionMesh **meshes, int count);
+bool GetGroundHeight(GroundField *f, BoundingBox box, Vector3 pos, float minY, float maxY, int obj, float *outY);
+void UnloadGroundField(GroundField *f);
+
+#endif // GROUND_FIELD_H
@@ -0,0 +1,98 @@
+#include "headless.h"
+#include "game.h"
+#include "level.h"
+#include "timer.h"
+#include "arena.h"
+#include "raylib.h"
+#include "rlgl.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+//null GL driver, raylib loads every GL entry point through NullGlProc instead of the window's context
+//all of them land on one function that ignores its arguments and returns 0, so every id raylib asks for is 0
+//and nothing is ever uploaded, bound or drawn, the cpu side of meshes, textures and shaders is loaded as usual
+//calling it through the real GL signatures is only safe where the caller cleans up, see HEADLESS_SUPPORTED
+static const char *nullGlVersion = "3.3 null";
+
+static const unsigned char *NullGlGetString(unsigned int name)
+{
+    (void)name;
+    return (const unsigned char *)nullGlVersion;
+}
+
+static int NullGlCall(void)
+{
+    return 0;
+}
+
+static void *NullGlProc(const char *name)
+{
+    if(strcmp(name, "glGetString") == 0){return (void *)NullGlGetString;}
+    return (void *)NullGlCall;
+}
+
+static double WallSeconds(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+//instead of InitWindow, rlgl on the null driver, the loaders and the instancing shader then work without a display
+void InitHeadless(void)
+{
+    SetTraceLogLevel(LOG_ERROR);//every texture and shader "fails" to load on the null driver
+    rlLoadExtensions((void *)NullGlProc);
+    rlglInit(SCREEN_WIDTH, SCREEN_HEIGHT);
+}
+
+//plays the map for a fixed number of frames at HEADLESS_FRAME_TIME each, as fast as the cpu goes
+//no input, so the player stands at the start and the enemies come to them, lives just go below zero
+//the scene is still culled and queued, that is where dying enemies fade out, then counted instead of drawn
+HeadlessStats RunHeadless(GameState *gs, Level *l, const char *map, int frames)
+{
+    HeadlessStats s = {0};
+    printf("headless: loading %s\n", map);
+    double loadStart = WallSeconds();
+    *l = LoadLevel(map);
+    l->loaded = true;
+    gs->screen = SCREEN_PLAYING;
+    double loadSeconds = WallSeconds() - loadStart;
+
+    double runStart = WallSeconds();
+    for(int f = 0; f < frames; f++)
+    {
+        double frameStart = WallSeconds();
+        ResetFrameArena();
+        AdvanceGameClock(HEADLESS_FRAME_TIME);
+        UpdateGame(gs, l);
+        double updateEnd = WallSeconds();
+        QueueGameScene(gs, l);
+        SortRenderQueue(&gs->queue);
+        s.opaqueDraws += CountRenderQueuePass(&gs->queue, RENDER_PASS_OPAQUE);
+        s.instanceDraws += DiscardInstances(&gs->instances);
+        s.fadingDraws += CountRenderQueuePass(&gs->queue, RENDER_PASS_FADING);
+        double frameEnd = WallSeconds();
+        s.updateSeconds += updateEnd - frameStart;
+        s.sceneSeconds += frameEnd - updateEnd;
+        if(frameEnd - frameStart > s.worstFrameSeconds){s.worstFrameSeconds = frameEnd - frameStart;}
+        s.frames++;
+    }
+    double runSeconds = WallSeconds() - runStart;
+
+    double perFrame = s.frames > 0 ? 1.0 / s.frames : 0.0;
+    printf("headless: loaded in %.2f s, %d frames (%.1f s of game time) in %.2f s, %.1fx real time\n",
+        loadSeconds, s.frames, s.frames * HEADLESS_FRAME_TIME, runSeconds, runSeconds > 0.0 ? s.frames * HEADLESS_FRAME_TIME / runSeconds : 0.0);
+    printf("headless: per frame %.3f ms update, %.3f ms scene, worst frame %.3f ms\n",
+        s.updateSeconds * perFrame * 1000.0, s.sceneSeconds * perFrame * 1000.0, s.worstFrameSeconds * 1000.0);
+    printf("headless: per frame %.1f opaque, %.1f instanced, %.1f fading draws\n",
+        s.opaqueDraws * perFrame, s.instanceDraws * perFrame, s.fadingDraws * perFrame);
+    printf("headless: mc %d lives, %d score\n", l->mc.lives, l->mc.score);
+    return s;
+}
+
+void CloseHeadless(void)
+{
+    rlglClose();
+}
@@ -0,0 +1,34 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include "game.h"
+#include "level.h"
+
+//the null GL driver relies on caller cleaned calls, 32 bit windows GL is stdcall, and the web has no command line
+#if !defined(PLATFORM_WEB) && !(defined(_WIN32) && !defined(_WIN64))
+    #define HEADLESS_SUPPORTED
+#endif
+
+//constants
+#define HEADLESS_FRAME_TIME (1.0f / 60.0f) //seconds of game time per frame, what the window aims for
+#define HEADLESS_DEFAULT_FRAMES 3600 //one minute of game time
+#define HEADLESS_SEED 1u //fixed, so two runs of the same build play the same game
+
+//structs
+//summed over a headless run, draws are what the null renderer would have issued
+typedef struct {
+    int frames;
+    long opaqueDraws;
+    long fadingDraws;
+    long instanceDraws;
+    double updateSeconds; //wall time in UpdateGame
+    double sceneSeconds; //wall time culling, queueing and sorting the draws
+    double worstFrameSeconds;
+} HeadlessStats;
+
+//functions
+void InitHeadless(void);
+HeadlessStats RunHeadless(GameState *gs, Level *l, const char *map, int frames);
+void CloseHeadless(void);
+
+#endif // HEADLESS_H
@@ -0,0 +1,140 @@
+#include "instancing.h"
+#include "raylib.h"
+#include "raymath.h"
+#include "rlgl.h"
+#include <stdio.h>
+#include <string.h>
+
+//the default raylib shader with the model matrix coming in per instance
+static const char *instanceVs =
+    "#version 330\n"
+    "in vec3 vertexPosition;\n"
+    "in vec2 vertexTexCoord;\n"
+    "in vec4 vertexColor;\n"
+    "in mat4 instanceTransform;\n"
+    "uniform mat4 mvp;\n"
+    "out vec2 fragTexCoord;\n"
+    "out vec4 fragColor;\n"
+    "void main()\n"
+    "{\n"
+    "    fragTexCoord = vertexTexCoord;\n"
+    "    fragColor = vertexColor;\n"
+    "    gl_Position = mvp*instanceTransform*vec4(vertexPosition, 1.0);\n"
+    "}\n";
+
+static const char *instanceFs =
+    "#version 330\n"
+    "in vec2 fragTexCoord;\n"
+    "in vec4 fragColor;\n"
+    "uniform sampler2D texture0;\n"
+    "uniform vec4 colDiffuse;\n"
+    "out vec4 finalColor;\n"
+    "void main()\n"
+    "{\n"
+    "    finalColor = texture(texture0, fragTexCoord)*colDiffuse*fragColor;\n"
+    "}\n";
+
+//needs a window, the shader is only loaded on GL 3.3 and up
+//GLES2 (web, pi) only instances through an extension raylib may not have found, so those draw one by one
+void InitInstanceRenderer(InstanceRenderer *r)
+{
+    *r = (InstanceRenderer){0};
+    int version = rlGetVersion();
+    if(version != RL_OPENGL_33 && version != RL_OPENGL_43)
+    {
+        printf("instancing: off for this GL version, props are drawn one by one\n");
+        return;
+    }
+    r->shader = LoadShaderFromMemory(instanceVs, instanceFs);
+    if(r->shader.id == 0 || r->shader.id == rlGetShaderIdDefault())
+    {
+        printf("instancing: shader failed, props are drawn one by one\n");
+        r->shader = (Shader){0};
+        return;
+    }
+    r->shader.locs[SHADER_LOC_MATRIX_MVP] = GetShaderLocation(r->shader, "mvp");
+    r->shader.locs[SHADER_LOC_MATRIX_MODEL] = GetShaderLocationAttrib(r->shader, "instanceTransform");
+    r->enabled = true;
+}
+
+//queues one instance of a shared model at pos, models are told apart by their mesh array
+//false when the table is full of other models, the caller draws it some other way
+bool AddInstance(InstanceRenderer *r, Model model, Vector3 pos)
+{
+    InstanceList *list = NULL;
+    for(int i = 0; i < r->listCount; i++)
+    {
+        if(r->lists[i].model.meshes == model.meshes){list = &r->lists[i]; break;}
+    }
+    if(list == NULL)
+    {
+        if(r->listCount == INSTANCE_MAX_MODELS){return false;}
+        list = &r->lists[r->listCount++];
+        list->model = model;
+        list->count = 0;
+    }
+    if(list->count == list->capacity)
+    {
+        list->capacity = list->capacity > 0 ? list->capacity * 2 : 64;
+        list->transforms = MemRealloc(list->transforms, sizeof(Matrix) * list->capacity);
+    }
+    //same matrix DrawModel builds, model.transform first
+    list->transforms[list->count++] = MatrixMultiply(model.transform, MatrixTranslate(pos.x, pos.y, pos.z));
+    return true;
+}
+
+//draws everything queued since the last flush, one instanced call per mesh of every shared model
+void FlushInstances(InstanceRenderer *r)
+{
+    for(int i = 0; i < r->listCount; i++)
+    {
+        InstanceList *list = &r->lists[i];
+        if(!r->enabled || list->count < INSTANCE_MIN_COUNT)
+        {
+            for(int j = 0; j < list->count; j++)
+            {
+                for(int m = 0; m < list->model.meshCount; m++)
+                {
+                    DrawMesh(list->model.meshes[m], list->model.materials[list->model.meshMaterial[m]], list->transforms[j]);
+                }
+            }
+        }
+        else
+        {
+            for(int m = 0; m < list->model.meshCount; m++)
+            {
+                Material mat = list->model.materials[list->model.meshMaterial[m]];
+                mat.shader = r->shader;
+                DrawMeshInstanced(list->model.meshes[m], mat, list->transforms, list->count);
+            }
+        }
+        list->count = 0;
+    }
+    //models are matched again next frame, the transform buffers stay with their slot
+    r->listCount = 0;
+}
+
+//null renderer side of FlushInstances, empties the lists and returns the draw calls the flush would have made
+int DiscardInstances(InstanceRenderer *r)
+{
+    int draws = 0;
+    for(int i = 0; i < r->listCount; i++)
+    {
+        InstanceList *list = &r->lists[i];
+        bool instanced = r->enabled && list->count >= INSTANCE_MIN_COUNT;
+        draws += list->model.meshCount * (instanced ? 1 : list->count);
+        list->count = 0;
+    }
+    r->listCount = 0;
+    return draws;
+}
+
+void UnloadInstanceRenderer(InstanceRenderer *r)
+{
+    for(int i = 0; i < INSTANCE_MAX_MODELS; i++)
+    {
+        if(r->lists[i].transforms){MemFree(r->lists[i].transforms);}
+    }
+    if(r->shader.id != 0){UnloadShader(r->shader);}
+    *r = (InstanceRenderer){0};
+}
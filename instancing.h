@@ -0,0 +1,33 @@
+#ifndef INSTANCING_H
+#define INSTANCING_H
+
+#include "raylib.h"
+
+//constants
+#define INSTANCE_MAX_MODELS 16 //shared models collected per frame, AddInstance turns away any more
+#define INSTANCE_MIN_COUNT 2 //fewer instances than this are cheaper as plain DrawModel calls
+
+//structs
+//every visible instance of one shared model this frame
+typedef struct {
+    Model model; //copy, meshes and materials are shared with the owner
+    Matrix *transforms;
+    int count;
+    int capacity; //grows, never shrinks, so steady frames do not allocate
+} InstanceList;
+
+typedef struct {
+    Shader shader; //instancing shader, id 0 when the GL version has no instancing and everything is drawn one by one
+    bool enabled;
+    InstanceList lists[INSTANCE_MAX_MODELS];
+    int listCount;
+} InstanceRenderer;
+
+//functions
+void InitInstanceRenderer(InstanceRenderer *r);
+bool AddInstance(InstanceRenderer *r, Model model, Vector3 pos);
+void FlushInstances(InstanceRenderer *r);
+int DiscardInstances(InstanceRenderer *r);
+void UnloadInstanceRenderer(InstanceRenderer *r);
+
+#endif // INSTANCING_H
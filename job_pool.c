@@ -0,0 +1,100 @@
+#include "job_pool.h"
+#include <stdio.h>
+#include <stdbool.h>
+
+#ifndef JOB_POOL_NO_THREADS
+#include <pthread.h>
+
+//one parallel for at a time, workers and the main thread take indices until there are none left
+static pthread_t workers[JOB_POOL_MAX_WORKERS];
+static int workerCount = 0;
+static pthread_mutex_t jobLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t jobWake = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t jobDone = PTHREAD_COND_INITIALIZER;
+static JobFunc jobFn = NULL;
+static void *jobCtx = NULL;
+static int jobCount = 0;
+static int jobNext = 0;
+static int jobsFinished = 0;
+static bool quitting = false;
+
+//called with jobLock held, runs one job unlocked and takes the lock back
+static void RunOneJob(void)
+{
+    int index = jobNext++;
+    JobFunc fn = jobFn;
+    void *ctx = jobCtx;
+    pthread_mutex_unlock(&jobLock);
+    fn(ctx, index);
+    pthread_mutex_lock(&jobLock);
+    if(++jobsFinished == jobCount){pthread_cond_signal(&jobDone);}
+}
+
+static void *WorkerMain(void *arg)
+{
+    (void)arg;
+    pthread_mutex_lock(&jobLock);
+    while(true)
+    {
+        while(!quitting && jobNext >= jobCount){pthread_cond_wait(&jobWake, &jobLock);}
+        if(quitting){break;}
+        RunOneJob();
+    }
+    pthread_mutex_unlock(&jobLock);
+    return NULL;
+}
+#endif
+
+void InitJobPool(int count)
+{
+#ifndef JOB_POOL_NO_THREADS
+    if(count > JOB_POOL_MAX_WORKERS){count = JOB_POOL_MAX_WORKERS;}
+    quitting = false;
+    for(int i = 0; i < count; i++)
+    {
+        if(pthread_create(&workers[i], NULL, WorkerMain, NULL) != 0){break;}
+        workerCount++;
+    }
+    printf("job pool: %d workers\n", workerCount);
+#else
+    (void)count;
+    printf("job pool: no threads, jobs run on the main thread\n");
+#endif
+}
+
+//runs fn(ctx, 0 .. count-1) spread over the workers and the main thread, returns when all are done
+void RunJobs(JobFunc fn, void *ctx, int count)
+{
+    if(count <= 0){return;}
+#ifndef JOB_POOL_NO_THREADS
+    if(workerCount > 0)
+    {
+        pthread_mutex_lock(&jobLock);
+        jobFn = fn;
+        jobCtx = ctx;
+        jobCount = count;
+        jobNext = 0;
+        jobsFinished = 0;
+        pthread_cond_broadcast(&jobWake);
+        while(jobNext < jobCount){RunOneJob();}
+        while(jobsFinished < jobCount){pthread_cond_wait(&jobDone, &jobLock);}
+        jobCount = 0;
+        jobNext = 0;
+        pthread_mutex_unlock(&jobLock);
+        return;
+    }
+#endif
+    for(int i = 0; i < count; i++){fn(ctx, i);}
+}
+
+void UnloadJobPool(void)
+{
+#ifndef JOB_POOL_NO_THREADS
+    pthread_mutex_lock(&jobLock);
+    quitting = true;
+    pthread_cond_broadcast(&jobWake);
+    pthread_mutex_unlock(&jobLock);
+    for(int i = 0; i < workerCount; i++){pthread_join(workers[i], NULL);}
+    workerCount = 0;
+#endif
+}
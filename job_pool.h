@@ -0,0 +1,21 @@
+#ifndef JOB_POOL_H
+#define JOB_POOL_H
+
+//constants
+#define JOB_POOL_WORKERS 3 //threads besides the main one, a pi 4 has four cores
+#define JOB_POOL_MAX_WORKERS 8
+
+//web builds have no threads, jobs run on the main thread there
+#if defined(PLATFORM_WEB)
+    #define JOB_POOL_NO_THREADS
+#endif
+
+//structs
+typedef void (*JobFunc)(void *ctx, int index);
+
+//functions
+void InitJobPool(int count);
+void RunJobs(JobFunc fn, void *ctx, int count);
+void UnloadJobPool(void);
+
+#endif // JOB_POOL_H
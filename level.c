@@ -1,4 +1,5 @@
 #include "level.h"
+#include "los.h"
 #include "map_parser.h"
 #include "timer.h"
 #include "raylib.h"
@@ -52,92 +53,6 @@ BoundingBox UpdateBoundingBox(BoundingBox box, Vector3 pos)
     return newBox;
 }
 
-static Mesh DeepCopyMesh(Mesh src)
-{
-    Mesh dst = src;
-
-    // Deep copy mandatory buffers
-    dst.vertices    = MemAlloc(sizeof(float) * src.vertexCount * 3);
-    dst.normals     = MemAlloc(sizeof(float) * src.vertexCount * 3);
-    dst.texcoords   = MemAlloc(sizeof(float) * src.vertexCount * 2);
-    dst.indices     = MemAlloc(sizeof(unsigned short) * src.triangleCount * 3);
-
-    memcpy(dst.vertices, src.vertices, sizeof(float) * src.vertexCount * 3);
-    memcpy(dst.normals, src.normals, sizeof(float) * src.vertexCount * 3);
-    memcpy(dst.texcoords, src.texcoords, sizeof(float) * src.vertexCount * 2);
-    memcpy(dst.indices, src.indices, sizeof(unsigned short) * src.triangleCount * 3);
-
-    // Optional buffers
-    dst.tangents = src.tangents ? MemAlloc(sizeof(float) * src.vertexCount * 4) : NULL;
-    if (src.tangents) memcpy(dst.tangents, src.tangents, sizeof(float) * src.vertexCount * 4);
-
-    dst.colors = src.colors ? MemAlloc(sizeof(unsigned char) * src.vertexCount * 4) : NULL;
-    if (src.colors) memcpy(dst.colors, src.colors, sizeof(unsigned char) * src.vertexCount * 4);
-
-    dst.texcoords2 = src.texcoords2 ? MemAlloc(sizeof(float) * src.vertexCount * 2) : NULL;
-    if (src.texcoords2) memcpy(dst.texcoords2, src.texcoords2, sizeof(float) * src.vertexCount * 2);
-
-    dst.boneIds = src.boneIds ? MemAlloc(sizeof(unsigned char) * src.vertexCount * 4) : NULL;
-    if (src.boneIds) memcpy(dst.boneIds, src.boneIds, sizeof(unsigned char) * src.vertexCount * 4);
-
-    dst.boneWeights = src.boneWeights ? MemAlloc(sizeof(float) * src.vertexCount * 4) : NULL;
-    if (src.boneWeights) memcpy(dst.boneWeights, src.boneWeights, sizeof(float) * src.vertexCount * 4);
-
-    dst.animVertices = src.animVertices ? MemAlloc(sizeof(float) * src.vertexCount * 3) : NULL;
-    if (src.animVertices) memcpy(dst.animVertices, src.animVertices, sizeof(float) * src.vertexCount * 3);
-
-    dst.animNormals = src.animNormals ? MemAlloc(sizeof(float) * src.vertexCount * 3) : NULL;
-    if (src.animNormals) memcpy(dst.animNormals, src.animNormals, sizeof(float) * src.vertexCount * 3);
-
-    // Clear GPU IDs to trigger re-upload
-    dst.vaoId = 0;
-    for (int i = 0; i < MAX_MESH_VERTEX_BUFFERS; i++) dst.vboId[i] = 0;
-
-    return dst;
-}
-
-Model DeepCopyModel(Model src)
-{
-    Model dst = src;
-
-    // Deep copy meshes
-    dst.meshes = MemAlloc(sizeof(Mesh) * src.meshCount);
-    for (int i = 0; i < src.meshCount; i++)
-    {
-        dst.meshes[i] = DeepCopyMesh(src.meshes[i]);
-        UploadMesh(&dst.meshes[i], true);
-    }
-
-    // Deep copy mesh-material mapping
-    dst.meshMaterial = MemAlloc(sizeof(int) * src.meshCount);
-    memcpy(dst.meshMaterial, src.meshMaterial, sizeof(int) * src.meshCount);
-
-    // Deep copy materials
-    dst.materials = MemAlloc(sizeof(Material) * src.materialCount);
-    for (int i = 0; i < src.materialCount; i++)
-    {
-        dst.materials[i] = src.materials[i];
-        dst.materials[i].maps = MemAlloc(sizeof(MaterialMap) * MAX_MATERIAL_MAPS);
-        memcpy(dst.materials[i].maps, src.materials[i].maps, sizeof(MaterialMap) * MAX_MATERIAL_MAPS);
-    }
-
-    // Deep copy bones
-    dst.bones = src.boneCount > 0 ? MemAlloc(sizeof(BoneInfo) * src.boneCount) : NULL;
-    for (int i = 0; i < src.boneCount; i++)
-    {
-        dst.bones[i] = src.bones[i];
-    }
-
-    // Deep copy bind pose
-    dst.bindPose = src.boneCount > 0 ? MemAlloc(sizeof(Transform) * src.boneCount) : NULL;
-    for (int i = 0; i < src.boneCount; i++)
-    {
-        dst.bindPose[i] = src.bindPose[i];
-    }
-
-    return dst;
-}
-
 bool IsPowerOfTwo(int x) {
     return (x & (x - 1)) == 0;
 }
@@ -146,6 +61,13 @@ bool IsTexturePOT(Texture2D tex) {
     return IsPowerOfTwo(tex.width) && IsPowerOfTwo(tex.height);
 }
 
+//no audio device (headless runs) leaves the sound empty, raylib plays and unloads empty sounds as no-ops
+Sound LoadSoundIfAudio(const char *filename)
+{
+    if(!IsAudioDeviceReady()){return (Sound){0};}
+    return LoadSound(filename);
+}
+
 Texture GetText(const char *filename)
 {
     Image image = LoadImage(filename);
@@ -236,20 +158,40 @@ Level LoadLevel(const char *filename)
     level.uNumAnimations[0] = armyAnimCount;
     level.uAnimations[1] =yetiAnimations;
     level.uNumAnimations[1] = yetiAnimCount;
+    //per bone shot boxes, from the skin weights of the shared models
+    level.boneHitSetCount = 2;
+    level.boneHitSets = MemAlloc(sizeof(BoneHitSet) * level.boneHitSetCount);
+    level.boneHitSets[0] = BuildBoneHitSet(armyModel);
+    level.boneHitSets[1] = BuildBoneHitSet(yetiModel);
+    //simplified levels for the models that are drawn far away a lot, 0 tree, 1 bg tree, 2 army, 3 yeti
+    level.modelLodCount = 4;
+    level.modelLods = MemAlloc(sizeof(ModelLods) * level.modelLodCount);
+    level.modelLods[0] = BuildModelLods(treeModel);
+    level.modelLods[1] = BuildModelLods(treeBgModel);
+    level.modelLods[2] = BuildModelLods(armyModel);
+    level.modelLods[3] = BuildModelLods(yetiModel);
+    //skinned frames shared by all enemies of a model, one cache per mesh lod
+    level.skinCacheCount = 2 * MESH_LOD_LEVELS;
+    level.skinCaches = MemAlloc(sizeof(SkinCache) * level.skinCacheCount);
+    for(int lod = 0; lod < MESH_LOD_LEVELS; lod++)
+    {
+        InitSkinCache(&level.skinCaches[lod], level.modelLods[2].lods[lod], armyAnimations, armyAnimCount);
+        InitSkinCache(&level.skinCaches[MESH_LOD_LEVELS + lod], level.modelLods[3].lods[lod], yetiAnimations, yetiAnimCount);
+    }
     
     //sounds
     printf("sounds\n");
-    Sound deathSound = LoadSound("sounds/scream.mp3");
-    Sound looseSound = LoadSound("sounds/mc_death.mp3");
-    Sound yetiRoar = LoadSound("sounds/yeti_roar.mp3");
-    Sound bgHit = LoadSound("sounds/bg_hit.mp3");
-    Sound bgDeath = LoadSound("sounds/bg_death.mp3");
-    Sound bgShoot = LoadSound("sounds/bg_shoot.mp3");
-    Sound shotgunSound = LoadSound("sounds/shotgun.mp3");
-    Sound m1grandSound = LoadSound("sounds/m1grand.mp3");
-    Sound landSound = LoadSound("sounds/land.mp3");
-    Sound healthSound = LoadSound("sounds/health.mp3");
-    Sound reloadSound = LoadSound("sounds/reload.mp3");
+    Sound deathSound = LoadSoundIfAudio("sounds/scream.mp3");
+    Sound looseSound = LoadSoundIfAudio("sounds/mc_death.mp3");
+    Sound yetiRoar = LoadSoundIfAudio("sounds/yeti_roar.mp3");
+    Sound bgHit = LoadSoundIfAudio("sounds/bg_hit.mp3");
+    Sound bgDeath = LoadSoundIfAudio("sounds/bg_death.mp3");
+    Sound bgShoot = LoadSoundIfAudio("sounds/bg_shoot.mp3");
+    Sound shotgunSound = LoadSoundIfAudio("sounds/shotgun.mp3");
+    Sound m1grandSound = LoadSoundIfAudio("sounds/m1grand.mp3");
+    Sound landSound = LoadSoundIfAudio("sounds/land.mp3");
+    Sound healthSound = LoadSoundIfAudio("sounds/health.mp3");
+    Sound reloadSound = LoadSoundIfAudio("sounds/reload.mp3");
     printf("sounds malloc\n");
     level.uniqueSounds = 11;
     level.uSounds = MemAlloc(sizeof(Sound) * level.uniqueSounds);
@@ -312,6 +254,8 @@ Level LoadLevel(const char *filename)
     mc.weapons[WEAPON_M1GRAND].rot = 90;
     mc.weapons[WEAPON_M1GRAND].maxDist = 35;
     mc.weapons[WEAPON_M1GRAND].damage = 15;
+    mc.weapons[WEAPON_M1GRAND].pellets = 1;
+    mc.weapons[WEAPON_M1GRAND].spread = 0;
     mc.weapons[WEAPON_M1GRAND].ammo = 25;
     mc.weapons[WEAPON_M1GRAND].shootSound = m1grandSound;
     //shotgun
@@ -322,6 +266,8 @@ Level LoadLevel(const char *filename)
     mc.weapons[WEAPON_SHOTGUN].rot = 90;
     mc.weapons[WEAPON_SHOTGUN].maxDist = 16;
     mc.weapons[WEAPON_SHOTGUN].damage = 30;
+    mc.weapons[WEAPON_SHOTGUN].pellets = SHOTGUN_PELLETS;
+    mc.weapons[WEAPON_SHOTGUN].spread = SHOTGUN_SPREAD;
     mc.weapons[WEAPON_SHOTGUN].ammo = 15;
     mc.weapons[WEAPON_SHOTGUN].shootSound = shotgunSound;
     //mc sounds
@@ -359,6 +305,9 @@ Level LoadLevel(const char *filename)
             objects[objCount].pointEntity = false;
             objects[objCount].type = WORLDSPAWN_GROUND;
             objects[objCount].model = entities[i].model;
+            objects[objCount].planeCount = entities[i].planeCount;
+            objects[objCount].planes = entities[i].planes;
+            entities[i].planes = NULL; //object owns them now
             objects[objCount].model.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = groundTexture;
             if(entities[i].hasSubType)
             {
@@ -375,6 +324,9 @@ Level LoadLevel(const char *filename)
             memset(&objects[objCount], 0, sizeof(EnvObject));
             objects[objCount].pointEntity = false;
             objects[objCount].model = entities[i].model;
+            objects[objCount].planeCount = entities[i].planeCount;
+            objects[objCount].planes = entities[i].planes;
+            entities[i].planes = NULL; //object owns them now
             objects[objCount].model.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = wallTexture;
             if(entities[i].hasSubType)
             {
@@ -391,6 +343,9 @@ Level LoadLevel(const char *filename)
             objects[objCount].pointEntity = false;
             objects[objCount].type = OBJECT_PLATFORM;
             objects[objCount].model = entities[i].model;
+            objects[objCount].planeCount = entities[i].planeCount;
+            objects[objCount].planes = entities[i].planes;
+            entities[i].planes = NULL; //object owns them now
             objects[objCount].model.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = platTexture;
             objCount++;
         }
@@ -440,15 +395,9 @@ Level LoadLevel(const char *filename)
         else if(strcmp(entities[i].className,"monster_army")==0)
         {
             memset(&badguys[bgCount], 0, sizeof(Enemy));
-            //for now we open the army man more than once and just do that
-            //Model armyModel = LoadModel("models/soldier_anim.glb");
             badguys[bgCount].type = BG_TYPE_ARMY;
             badguys[bgCount].drawColor = WHITE; //always white
-            #ifdef MEMORY_SAFE_MODE
-                badguys[bgCount].model = LoadModel("models/soldier_4_anim.glb");
-            #else
-                badguys[bgCount].model = DeepCopyModel(armyModel);
-            #endif
+            badguys[bgCount].model = armyModel; //shared, the pose lives in the enemy and the skinned frame in the skin cache
             if(entities[i].hasSubType)
             {
                 if(strcmp(entities[i].subType,"shooter")==0)
@@ -458,6 +407,8 @@ Level LoadLevel(const char *filename)
             }
             badguys[bgCount].anims = armyAnimations;
             badguys[bgCount].animCount = armyAnimCount;
+            badguys[bgCount].boneHits = level.boneHitSets[0].boneCount > 0 ? &level.boneHitSets[0] : NULL;
+            badguys[bgCount].skin = level.skinCaches[0].boneMats ? &level.skinCaches[0] : NULL;
             badguys[bgCount].pos = entities[i].origin;
             badguys[bgCount].pos.y-=0.1f;//they float, origin problem
             badguys[bgCount].yOffset=0.3f;//the model itself is defined below where it needs to be, offset to correct
@@ -481,13 +432,11 @@ Level LoadLevel(const char *filename)
             memset(&badguys[bgCount], 0, sizeof(Enemy));
             badguys[bgCount].type = BG_TYPE_YETI;
             badguys[bgCount].drawColor = WHITE;
-            #ifdef MEMORY_SAFE_MODE
-                badguys[bgCount].model = LoadModel("models/yeti_anim_2.glb");
-            #else
-                badguys[bgCount].model = DeepCopyModel(yetiModel);
-            #endif
+            badguys[bgCount].model = yetiModel; //shared like the army model
             badguys[bgCount].anims = yetiAnimations;
             badguys[bgCount].animCount = yetiAnimCount;
+            badguys[bgCount].boneHits = level.boneHitSets[1].boneCount > 0 ? &level.boneHitSets[1] : NULL;
+            badguys[bgCount].skin = level.skinCaches[MESH_LOD_LEVELS].boneMats ? &level.skinCaches[MESH_LOD_LEVELS] : NULL;
             badguys[bgCount].pos = entities[i].origin;
             badguys[bgCount].pos.y+=0.0f;
             badguys[bgCount].yOffset=0.0f;
@@ -557,6 +506,9 @@ Level LoadLevel(const char *filename)
             memset(&objects[objCount], 0, sizeof(EnvObject));
             objects[objCount].pointEntity = false;
             objects[objCount].model = entities[i].model;
+            objects[objCount].planeCount = entities[i].planeCount;
+            objects[objCount].planes = entities[i].planes;
+            entities[i].planes = NULL; //object owns them now
             objects[objCount].model.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = roofTexture;
             if(entities[i].hasSubType)
             {
@@ -587,10 +539,15 @@ Level LoadLevel(const char *filename)
     level.itemCount = itemCount;
 
     
-    //free the entities to prevent corruption later
+    //free the entities to prevent corruption later, planes of brushes that did not become objects go with them
+    for(int i =0; i < entityCount; i++)
+    {
+        if(entities[i].planes){MemFree(entities[i].planes);}
+    }
     MemFree(entities);
 
     int totalEnvTri = 0;
+    int totalBvhNodes = 0;
     for(int i =0; i < level.objCount; i++)
     {
         if(level.obj[i].useOrigin && !level.obj[i].pointEntity){printf("object uses origin but is not point entity: %d ?\n",i);}
@@ -599,6 +556,79 @@ Level LoadLevel(const char *filename)
         if(level.obj[i].useOrigin){level.obj[i].box=UpdateBoundingBox(level.obj[i].box,level.obj[i].origin);}
         level.obj[i].pos = PositionFromBox(level.obj[i].box);
         level.obj[i].radius = RadiusFromModelAndCenter(level.obj[i].pos,level.obj[i].model);
+        if(!level.obj[i].pointEntity)
+        {
+            level.obj[i].colMesh = BuildCollisionMesh(level.obj[i].model.meshes[0]);
+            totalBvhNodes+=level.obj[i].colMesh.bvh.nodeCount;
+        }
+        level.obj[i].lods = -1;
+        for(int m = 0; m < level.modelLodCount && level.obj[i].pointEntity; m++)
+        {
+            if(level.modelLods[m].lods[0].meshes == level.obj[i].model.meshes){level.obj[i].lods = m;}
+        }
+    }
+    //broadphase grid, hit box objects go in with their hit boxes merged into the box
+    BoundingBox gridBoxes[MAX_ENV_OBJECTS];
+    for(int i =0; i < level.objCount; i++)
+    {
+        gridBoxes[i] = level.obj[i].box;
+        for(int h =0; h < level.obj[i].hitBoxCount; h++)
+        {
+            gridBoxes[i].min = Vector3Min(gridBoxes[i].min, level.obj[i].hitBoxes[h].min);
+            gridBoxes[i].max = Vector3Max(gridBoxes[i].max, level.obj[i].hitBoxes[h].max);
+        }
+    }
+    level.grid = BuildWorldGrid(gridBoxes, level.objCount, WORLD_GRID_CELL_SIZE);
+    const CollisionMesh *groundMeshes[MAX_ENV_OBJECTS];
+    for(int i =0; i < level.objCount; i++)
+    {
+        groundMeshes[i] = level.obj[i].pointEntity ? NULL : &level.obj[i].colMesh;
+    }
+    level.ground = BuildGroundField(groundMeshes, level.objCount);
+    //raycast scene, hit box objects block rays with their hit boxes only, brushes with their planes
+    RayPrim *rayPrims = MemAlloc(sizeof(RayPrim) * level.objCount * MAX_HIT_BOXES);
+    int rayPrimCount = 0;
+    for(int i =0; i < level.objCount; i++)
+    {
+        if(level.obj[i].useHitBoxes)
+        {
+            for(int h =0; h < level.obj[i].hitBoxCount; h++)
+            {
+                rayPrims[rayPrimCount++] = (RayPrim){ level.obj[i].hitBoxes[h], i, h, 0, NULL };
+            }
+        }
+        else{rayPrims[rayPrimCount++] = (RayPrim){ level.obj[i].box, i, -1, level.obj[i].planeCount, level.obj[i].planes };}
+    }
+    level.raycast = BuildRaycastScene(rayPrims, rayPrimCount);
+    MemFree(rayPrims);
+    InitLosService(&level);
+    //potentially visible sets, the world and platforms are floors, wall and crate tops count where they can be jumped onto from one
+    bool floorObj[MAX_ENV_OBJECTS];
+    BoundingBox pvsBounds = (BoundingBox){0};
+    bool pvsBoundsSet = false;
+    for(int i =0; i < level.objCount; i++)
+    {
+        floorObj[i] = level.obj[i].type == WORLDSPAWN_GROUND || level.obj[i].type == OBJECT_PLATFORM;
+        level.obj[i].pvsVisible = true;
+        if(level.obj[i].pointEntity){continue;}
+        if(!pvsBoundsSet){pvsBounds = level.obj[i].box; pvsBoundsSet = true;}
+        pvsBounds.min = Vector3Min(pvsBounds.min, level.obj[i].box.min);
+        pvsBounds.max = Vector3Max(pvsBounds.max, level.obj[i].box.max);
+    }
+    if(pvsBoundsSet){level.pvs = BuildPvs(&level.raycast, &level.ground, floorObj, pvsBounds);}
+    TrackRaycastObjects(&level.raycast, level.objCount);//after the pvs, its jobs query the scene on several threads
+    level.pvsCell = -1;
+    //static batches, every brush is merged with the others sharing its texture in its chunk
+    const Model *batchModels[MAX_ENV_OBJECTS];
+    int objBatch[MAX_ENV_OBJECTS];
+    for(int i =0; i < level.objCount; i++)
+    {
+        batchModels[i] = level.obj[i].pointEntity ? NULL : &level.obj[i].model;
+    }
+    level.batches = BuildStaticBatches(batchModels, level.objCount, objBatch, &level.batchCount);
+    for(int i =0; i < level.objCount; i++)
+    {
+        level.obj[i].batch = objBatch[i];
     }
     int totalBgTri = 0;
     for(int i =0; i < level.bgCount; i++)
@@ -610,6 +640,9 @@ Level LoadLevel(const char *filename)
         level.bg[i].box=UpdateBoundingBox(orig,level.bg[i].pos);
         level.bg[i].bodyBox=UpdateBoundingBox(level.bg[i].origBodyBox,level.bg[i].pos);
         level.bg[i].headBox=UpdateBoundingBox(level.bg[i].origHeadBox,level.bg[i].pos);
+        level.bg[i].poseAnim = -1;
+        level.bg[i].poseFrame = -1;
+        if(level.bg[i].boneHits){level.bg[i].poseBox = GetBonePoseBounds(level.bg[i].boneHits, NULL, -1);}
         level.bg[i].t_walk_stuck.virgin=false;
         level.bg[i].t_yeti_death_wait.virgin=false;
     }
@@ -620,29 +653,42 @@ Level LoadLevel(const char *filename)
         totalItemTri+=level.items[i].model.meshes[0].triangleCount;
         level.items[i].box=UpdateBoundingBox(GetModelBoundingBox(level.items[i].model),level.items[i].pos);
     }
+    //triangle mode edge lists, skinned frames reuse the lists of their lod mesh
+    for(int i =0; i < level.objCount; i++){AddWireframeModel(&level.wire, level.obj[i].model);}
+    for(int i =0; i < level.itemCount; i++){AddWireframeModel(&level.wire, level.items[i].model);}
+    for(int i =0; i < level.modelLodCount; i++)
+    {
+        for(int lod = 0; lod < MESH_LOD_LEVELS; lod++){AddWireframeModel(&level.wire, level.modelLods[i].lods[lod]);}
+    }
 
     printf("Total Triangles for env objects: %d\n",totalEnvTri);
     printf("Total Triangles for bad guys   : %d\n",totalBgTri);
     printf("Total Triangles for items      : %d\n",totalItemTri);
     printf("Total Triangles                : %d\n",totalBgTri + totalEnvTri + totalItemTri);
+    printf("Total BVH nodes for env objects: %d\n",totalBvhNodes);
     return level;
 }
 
 void UnloadLevel(Level * l)
 {
+    //skin caches borrow the model buffers, so they go first
+    for(int i=0;i<l->skinCacheCount;i++)
+    {
+        UnloadSkinCache(&l->skinCaches[i]);
+    }
+    if(l->skinCaches){MemFree(l->skinCaches);}
+    for(int i=0;i<l->modelLodCount;i++)
+    {
+        UnloadModelLods(&l->modelLods[i]);
+    }
+    if(l->modelLods){MemFree(l->modelLods);}
     printf("unload models\n");
     //unique models
     for(int i=0;i<l->uniqueModels;i++)
     {
         UnloadModel(l->uModels[i]);
     }
-    printf("unload bg models\n");
-    //badguys store deep copies of thier models, unload each
-    for(int i=0;i<l->bgCount;i++)
-    {
-        printf("attempting unload bg model %d/%d\n",i,l->bgCount);
-        UnloadModel(l->bg[i].model);
-    }
+    //badguys share the army and yeti models in uModels, nothing of their own to unload
     printf("unload env obj models\n");
     //envObjects that do not use origin use unique models, unload each
     for(int i=0;i<l->objCount;i++)
@@ -651,8 +697,23 @@ void UnloadLevel(Level * l)
         {
             printf("attempting to unload Object %d/%d\n",i,l->objCount);
             UnloadModel(l->obj[i].model);
+            UnloadCollisionMesh(&l->obj[i].colMesh);
+            if(l->obj[i].planes){MemFree(l->obj[i].planes);}
         }
     }
+    UnloadWorldGrid(&l->grid);
+    UnloadGroundField(&l->ground);
+    UnloadRaycastScene(&l->raycast);
+    UnloadPvs(&l->pvs);
+    UnloadWireframeSet(&l->wire);
+    UnloadStaticBatches(l->batches, l->batchCount);
+    for(int i=0;i<l->boneHitSetCount;i++)
+    {
+        UnloadBoneHitSet(&l->boneHitSets[i]);
+    }
+    if(l->boneHitSets){MemFree(l->boneHitSets);}
+    long losAsked = l->los.totalHits + l->los.totalMisses;
+    printf("line of sight cache: %ld hits, %ld misses (%.1f%% hit rate)\n", l->los.totalHits, l->los.totalMisses, losAsked > 0 ? 100.0 * l->los.totalHits / losAsked : 0.0);
     printf("unload anims\n");
     //unique anims
     for(int i=0;i<l->uniqueAnimations;i++)
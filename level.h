@@ -4,10 +4,17 @@
 #include "raylib.h"
 #include "map_parser.h"
 #include "timer.h"
+#include "collision_mesh.h"
+#include "broadphase.h"
+#include "ground_field.h"
+#include "raycast.h"
+#include "pvs.h"
+#include "bone_hitbox.h"
+#include "static_batch.h"
+#include "skin_cache.h"
+#include "mesh_lod.h"
+#include "wireframe.h"
 
-//for deep copy of Model/Meshes and stuff in the model
-#define MAX_MATERIAL_MAPS 12
-#define MAX_MESH_VERTEX_BUFFERS 7
 //constants for max list sizes
 #define MAX_ENV_OBJECTS 1024
 #define MAX_BAD_GUYS 64
@@ -15,6 +22,8 @@
 #define MAX_HIT_BOXES 8
 //constants for items and weapons and such
 #define TOTAL_WEAPON_TYPES 2
+#define SHOTGUN_PELLETS 10 //rays per shotgun shot, at most RAY_PACKET_MAX
+#define SHOTGUN_SPREAD 0.08f //radians, half angle of the pellet cone
 // Constants for jumping and falling and such
 #define GRAVITY 0.5f
 #define JUMP_FORCE 8.0f
@@ -27,6 +36,16 @@
 #define YETI_JUMP_FORCE 20.0f
 #define YETI_JUMP_FORCE 20.0f
 #define YETI_IMPACT_RADIUS 15
+//line of sight cache
+#define LOS_CACHE_TTL 0.25f //seconds a cached answer stays good, default for Level.los.ttl
+#define LOS_MOVE_EPSILON 0.5f //mc or bg moving further than this drops the cached answer
+#define LOS_MAX_BATCH_RAYS 8 //enemies the batch pass refreshes per frame, the rest keep their last answer
+//badguy animation playback and lod
+#define ANIM_FRAME_RATE 60.0f //keyframes per second, the speed the clips were tuned at under SetTargetFPS(60)
+#define ANIM_MAX_STEPS 30 //keyframes one update may advance, a long hitch skips time instead of replaying it
+#define ANIM_LOD_FULL_DIST 20.0f //closer than this the pose is refreshed every frame
+#define ANIM_LOD_HALF_DIST 45.0f //then every 2nd keyframe, then every 4th out to ANIM_LOD_MAX_DIST
+#define ANIM_LOD_MAX_DIST 100.0f //further away, or off screen, the pose is frozen while the clock keeps running
 //colors
 #define BLOODRED (Color){ 138, 3, 3, 255 }
 
@@ -79,6 +98,26 @@ typedef enum {
 } BgType;
 
 //structs
+//last line of sight answer for one enemy
+typedef struct {
+    bool valid;
+    bool visible;
+    bool requested; //asked for since the last batch pass
+    double time; //GetGameTime() when it was worked out
+    Vector3 mcPos; //where mc and bg stood at that time
+    Vector3 bgPos;
+} LosCache;
+
+typedef struct {
+    float ttl;
+    int next; //round robin start of the batch pass
+    int hits; //this frame
+    int misses;
+    int batchRays;
+    long totalHits;
+    long totalMisses;
+} LosService;
+
 typedef struct {
     BgType type;
     Model model;
@@ -88,12 +127,22 @@ typedef struct {
     ModelAnimation *anims;
     int animCount;
     int curFrame;
+    float frameTime; //fraction of the way from curFrame to the next keyframe
     BoundingBox box;
     BoundingBox origBox;
     BoundingBox headBox;
     BoundingBox origHeadBox;
     BoundingBox bodyBox;
     BoundingBox origBodyBox;
+    const BoneHitSet *boneHits; //per bone shot boxes of the model, NULL falls back to the body and head box
+    int poseAnim; //animation and frame on screen, -1 while in the bind pose, the model itself is shared and never posed
+    int poseFrame;
+    float poseBlend; //0..1 toward poseFrame + 1, only the skin cache draws it
+    float poseAge; //seconds since the pose was last refreshed, for the animation lod
+    BoundingBox poseBox; //model space bounds of the posed bone boxes, no yaw or position
+    SkinCache *skin; //skinned frames shared by every enemy of this model, NULL draws the bind pose
+    //MESH_LOD_LEVELS caches from skin on, one per mesh lod, poseLod picks the one the pose was skinned with
+    int poseLod;
     Vector3 pos;
     bool dead;
     float health;
@@ -113,6 +162,7 @@ typedef struct {
     Sound hitSound;
     Sound shootSound;
     Sound deathSound;
+    LosCache los;
 } Enemy;
 
 typedef struct {
@@ -131,7 +181,9 @@ typedef struct {
     Vector3 gunPos;//for the 3d camera that is used
     float rot;
     float maxDist;
-    float damage;
+    float damage; //per shot, split evenly over the pellets
+    int pellets; //rays per shot, 1 for a rifle
+    float spread; //radians, half angle of the pellet cone
     int ammo;
     Sound shootSound;
 } Weapon;
@@ -149,6 +201,14 @@ typedef struct {
     int hitBoxCount;
     BoundingBox hitBoxes[MAX_HIT_BOXES];
     bool noCOll;
+    CollisionMesh colMesh; //cached triangles + bvh for brush objects, built once at load
+    int planeCount;
+    BrushPlane *planes; //convex brush faces, taken from the map entity, NULL for point entities
+    int collisionCost; //collision tests against this object so far this frame, see collision_stats
+    float collisionHeat; //smoothed collisionCost, drives the debug tint
+    bool pvsVisible; //in the potentially visible set of the cell the camera is in
+    int batch; //static batch the model is drawn in, -1 when it is drawn on its own
+    int lods; //Level.modelLods entry of a shared point entity model, -1 when it has none
 } EnvObject;
 
 typedef struct {
@@ -197,6 +257,14 @@ typedef struct {
     //lists
     int objCount;
     EnvObject *obj;
+    WorldGrid grid; //broadphase over obj, item i is obj[i]
+    GroundField ground; //walkable surfaces of obj, for enemy ground snapping
+    RaycastScene raycast; //every static ray blocker, for shots and line of sight
+    LosService los; //cached enemy line of sight, see los.c
+    Pvs pvs; //which x/z cells can see which, built from the raycast scene at load
+    int pvsCell; //cell the camera was in when obj pvsVisible was last worked out, -1 outside the pvs
+    int batchCount;
+    StaticBatch *batches; //brush models merged by texture and chunk, drawn instead of the single brushes
     int bgCount;
     Enemy *bg;
     int itemCount;
@@ -211,9 +279,17 @@ typedef struct {
     int *uNumAnimations;
     int uniqueSounds;
     Sound *uSounds;
+    int boneHitSetCount;
+    BoneHitSet *boneHitSets; //one per skinned enemy model, enemies point in here
+    int skinCacheCount;
+    SkinCache *skinCaches; //MESH_LOD_LEVELS per skinned enemy model, enemies point in here
+    int modelLodCount;
+    ModelLods *modelLods; //simplified levels of the trees and enemy models
+    WireframeSet wire; //edge lists for triangle mode
 } Level;
 
 Level LoadLevel(const char *filename);
+Sound LoadSoundIfAudio(const char *filename);
 void UnloadLevel(Level * l);
 BoundingBox UpdateBoundingBox(BoundingBox box, Vector3 pos);
 void PrintVector3(char* mes, Vector3 v);
@@ -0,0 +1,110 @@
+#include "los.h"
+#include "level.h"
+#include "collision_stats.h"
+#include "timer.h"
+#include "raylib.h"
+#include "raymath.h"
+#include <stdio.h>
+
+//everything about the mc a sight ray needs, worked out once per batch instead of once per enemy
+typedef struct {
+    BoundingBox mcBox;
+    Vector3 mcPos;
+    Vector3 eyePos;
+} LosTargets;
+
+static LosTargets MakeLosTargets(Level *l)
+{
+    return (LosTargets){ l->mc.box, l->mc.pos, l->mc.camera.position };
+}
+
+//the actual rays, bg can see mc unless both the body ray and the eye ray are blocked
+static bool ComputeLineOfSight(Level *l, Vector3 origin, const LosTargets *t)
+{
+    //cells that cannot see each other need no rays at all, the bg cell gets the same ring IsBoxInPvs gives boxes
+    //a bg off the pvs (above its cell's samples) is left to the rays
+    if(GetPvsCell(&l->pvs, origin) >= 0 && !IsBoxInPvs(&l->pvs, GetPvsCell(&l->pvs, t->mcPos), (BoundingBox){ origin, origin })){return false;}
+    Ray bulletRay = (Ray){ origin, Vector3Normalize(Vector3Subtract(t->mcPos, origin)) };
+    Ray bulletRay2 = (Ray){ origin, Vector3Normalize(Vector3Subtract(t->eyePos, origin)) };
+    CountCollisionStat(STAT_BG_LINE_OF_SIGHT, STAT_RAY_BOX_TEST, 1);
+    RayCollision mcColl = GetRayCollisionBox(bulletRay, t->mcBox);
+    //report if its not a hit because that is strange
+    if(!mcColl.hit){printf("BgLineOfSightToMc, no hit on MC?\n");}
+    bool blocked = RaycastAny(&l->raycast, bulletRay, mcColl.distance);
+    CountRaycastStats(l, STAT_BG_LINE_OF_SIGHT);
+    if(blocked)
+    {
+        blocked = RaycastAny(&l->raycast, bulletRay2, mcColl.distance);
+        CountRaycastStats(l, STAT_BG_LINE_OF_SIGHT);
+    }
+    return !blocked;
+}
+
+static bool IsLosFresh(const Level *l, const Enemy *bg, double now)
+{
+    const LosCache *c = &bg->los;
+    return c->valid && now - c->time < l->los.ttl
+        && Vector3Distance(c->mcPos, l->mc.pos) < LOS_MOVE_EPSILON
+        && Vector3Distance(c->bgPos, bg->pos) < LOS_MOVE_EPSILON;
+}
+
+static void StoreLos(Level *l, Enemy *bg, bool visible, double now)
+{
+    bg->los = (LosCache){ true, visible, false, now, l->mc.pos, bg->pos };
+}
+
+void InitLosService(Level *l)
+{
+    l->los = (LosService){0};
+    l->los.ttl = LOS_CACHE_TTL;
+}
+
+//batch pass, run once a frame before the bg states update
+//refreshes the stale answers of enemies that asked since the last pass, at most LOS_MAX_BATCH_RAYS of them
+void UpdateLosService(Level *l)
+{
+    l->los.hits = 0;
+    l->los.misses = 0;
+    l->los.batchRays = 0;
+    if(l->bgCount == 0){return;}
+
+    double now = GetGameTime();
+    LosTargets targets = MakeLosTargets(l);
+    int start = l->los.next % l->bgCount;
+    for(int n = 0; n < l->bgCount && l->los.batchRays < LOS_MAX_BATCH_RAYS; n++)
+    {
+        int i = (start + n) % l->bgCount;
+        Enemy *bg = &l->bg[i];
+        if(!bg->los.requested){continue;}
+        if(bg->dead || bg->state == BG_STATE_DYING || bg->state == BG_STATE_STILL)
+        {
+            bg->los.requested = false;
+            continue;
+        }
+        if(IsLosFresh(l, bg, now)){continue;} //keep the request, it gets refreshed once it goes stale
+        StoreLos(l, bg, ComputeLineOfSight(l, bg->pos, &targets), now);
+        l->los.batchRays++;
+        l->los.next = i + 1;
+    }
+}
+
+//returns true if bg has line of sight to mc, never casts a ray itself
+//a stale answer is still returned, and asking puts bg in the next batch pass, so the rays per frame stay capped
+//a bg that never had an answer cannot see mc until the batch works one out
+bool BgLineOfSightToMc(Level *l, Enemy *bg, int index)
+{
+    (void)index;
+    bg->los.requested = true;
+    if(IsLosFresh(l, bg, GetGameTime()))
+    {
+        l->los.hits++;
+        l->los.totalHits++;
+    }
+    else
+    {
+        l->los.misses++;
+        l->los.totalMisses++;
+    }
+    //printf("bg %d can see mc: %d\n",index,bg->los.visible);
+    return bg->los.valid && bg->los.visible;
+}
@@ -0,0 +1,12 @@
+#ifndef LOS_H
+#define LOS_H
+
+#include "raylib.h"
+#include "level.h"
+
+//functions
+void InitLosService(Level *l);
+void UpdateLosService(Level *l);
+bool BgLineOfSightToMc(Level *l, Enemy *bg, int index);
+
+#endif // LOS_H
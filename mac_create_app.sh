@@ -14,7 +14,7 @@ RES_DIR="$APP_BUNDLE/Contents/Resources"
 PLIST="$APP_BUNDLE/Contents/Info.plist"
 
 # Flags
-CFLAGS="-I/usr/local/include -DPLATFORM_DESKTOP -DMEMORY_SAFE_MODE"
+CFLAGS="-I/usr/local/include -DPLATFORM_DESKTOP"
 LDFLAGS="/usr/local/lib/libraylib.a -lm \
   -framework OpenGL -framework Cocoa -framework IOKit -framework CoreAudio -framework CoreVideo"
 
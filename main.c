@@ -1,6 +1,10 @@
 #include "level.h"
 #include "game.h"
 #include "timer.h"
+#include "arena.h"
+#include "job_pool.h"
+#include "collision_stats.h"
+#include "headless.h"
 #include "raylib.h"
 #include "raymath.h"
 #include "rlgl.h"
@@ -38,8 +42,71 @@ void SetWorkingDirectoryToAppResources()
 #endif
 }
 
+//game state and everything shared by the window and headless runs
+void SetupGameState(void)
+{
+    //create level and game state
+    l = (Level){0};
+    l.loaded = false;
+    gs = (GameState){0};
+    //set the mouse capture to true, because we capture the moue by default
+    gs.isMouseCaptured = true;
+    //set quick fire to true, I found I like it much better
+    gs.quickFire = true;
+    //set music to on
+    gs.playMusic = true;
+    //screen and menu setup
+    gs.screen = SCREEN_MENU;
+    gs.menuCount = 3;
+    gs.menuSelection = 0;
+    gs.menuInGameCount = 4;
+    gs.menuInGameSelection = 0;
+    //fade color
+    gs.fadeColor = (Color){ 0, 0, 0, 0 };
+    gs.deathFadeColor = BLOODRED;
+    gs.deathFadeColor.a = 0;
+    //setup levels
+    gs.levelCount = 3;
+    gs.levelSelection=  0;
+    gs.levels = malloc(sizeof(MenuLevel) * gs.levelCount);
+    gs.levels[0] = (MenuLevel){"Open Space","maps/test001.map"};
+    gs.levels[1] = (MenuLevel){"The Maze","maps/test002.map"};
+    gs.levels[2] = (MenuLevel){"Dungeon","maps/dungeon.map"};
+    //timers
+    gs.t_crouch_wait = CreateTimer(0.0011f);
+    gs.t_crouch_wait.virgin = false;
+    gs.t_collDamage_wait = CreateTimer(0.666f);
+    gs.t_collDamage_wait.virgin = false;
+    gs.t_endLevel_wait = CreateTimer(5.0f);
+    gs.t_endLevel_wait.virgin = false;
+    //game state sounds
+    LoadGameStateSounds(&gs);
+    //instanced props, needs the window or the null renderer
+    InitInstanceRenderer(&gs.instances);
+    InitOcclusionBuffer(&gs.occlusion);
+    //skinning workers
+    InitJobPool(JOB_POOL_WORKERS);
+}
+
+void UnloadGame(void)
+{
+    if(l.loaded){UnloadLevel(&l);}
+    MemFree(gs.levels);
+    UnloadGameStateSounds(&gs);
+    UnloadInstanceRenderer(&gs.instances);
+    UnloadOcclusionBuffer(&gs.occlusion);
+    UnloadRenderQueue(&gs.queue);
+    UnloadJobPool();
+    UnloadFrameArena();
+    CloseCollisionStatsCsv();
+}
+
 void GameLoop(void) 
 {
+    //scratch from last frame is dead
+    ResetFrameArena();
+    //game time follows the wall clock here
+    AdvanceGameClock(GetFrameTime());
     //update music so it keeps playing
     UpdateMusicStream(gs.music);
     //always, in any screen, M will toggle mouse capture
@@ -83,9 +150,7 @@ void GameLoop(void)
             UpdateInGameMenu(&gs,&l);
             break;
         case SCREEN_EXIT:
-            if(l.loaded){UnloadLevel(&l);}
-            MemFree(gs.levels);
-            UnloadGameStateSounds(&gs);
+            UnloadGame();
             CloseAudioDevice();
             CloseWindow();
             #ifdef PLATFORM_WEB
@@ -96,10 +161,29 @@ void GameLoop(void)
     }
 }
 
-int main(void)
+int main(int argc, char **argv)
 {
     //this one is for Mac .app folder, to find asset folders
     SetWorkingDirectoryToAppResources();
+#ifdef HEADLESS_SUPPORTED
+    //--headless [frames] [level]: no window, audio or input, fixed steps as fast as it goes, for CI and soak runs
+    if(argc > 1 && strcmp(argv[1], "--headless") == 0)
+    {
+        int frames = argc > 2 ? atoi(argv[2]) : HEADLESS_DEFAULT_FRAMES;
+        int level = argc > 3 ? atoi(argv[3]) : 0;
+        srand(HEADLESS_SEED);
+        InitHeadless();
+        SetupGameState();
+        if(level < 0 || level >= gs.levelCount){level = 0;}
+        RunHeadless(&gs, &l, gs.levels[level].filename, frames);
+        UnloadGame();
+        CloseHeadless();
+        return 0;
+    }
+#else
+    (void)argc;
+    (void)argv;
+#endif
     //random behavior please
     srand((unsigned int)time(NULL));//this seeds with time for all other random calls
     //init window
@@ -111,42 +195,7 @@ int main(void)
     //set target FPS
     SetTargetFPS(60);
 
-    //create level and game state
-    l = (Level){0};
-    l.loaded = false;
-    gs = (GameState){0};
-    //set the mouse capture to true, because we capture the moue by default
-    gs.isMouseCaptured = true;
-    //set quick fire to true, I found I like it much better
-    gs.quickFire = true;
-    //set music to on
-    gs.playMusic = true;
-    //screen and menu setup
-    gs.screen = SCREEN_MENU;
-    gs.menuCount = 3;
-    gs.menuSelection = 0;
-    gs.menuInGameCount = 4;
-    gs.menuInGameSelection = 0;
-    //fade color
-    gs.fadeColor = (Color){ 0, 0, 0, 0 };
-    gs.deathFadeColor = BLOODRED;
-    gs.deathFadeColor.a = 0;
-    //setup levels
-    gs.levelCount = 3;
-    gs.levelSelection=  0;
-    gs.levels = malloc(sizeof(MenuLevel) * gs.levelCount);
-    gs.levels[0] = (MenuLevel){"Open Space","maps/test001.map"};
-    gs.levels[1] = (MenuLevel){"The Maze","maps/test002.map"};
-    gs.levels[2] = (MenuLevel){"Dungeon","maps/dungeon.map"};
-    //timers
-    gs.t_crouch_wait = CreateTimer(0.0011f);
-    gs.t_crouch_wait.virgin = false;
-    gs.t_collDamage_wait = CreateTimer(0.666f);
-    gs.t_collDamage_wait.virgin = false;
-    gs.t_endLevel_wait = CreateTimer(5.0f);
-    gs.t_endLevel_wait.virgin = false;
-    //game state sounds
-    LoadGameStateSounds(&gs);
+    SetupGameState();
     //play music
     PlayMusicStream(gs.music);
     SetMusicVolume(gs.music, 1.0f);
@@ -160,9 +209,7 @@ int main(void)
         }
     #endif
     
-    if(l.loaded){UnloadLevel(&l);}
-    MemFree(gs.levels);
-    UnloadGameStateSounds(&gs);
+    UnloadGame();
     CloseAudioDevice();
     CloseWindow();
 
@@ -182,6 +182,21 @@ static void SortPointsOnPlane(Vector3 *points, int count, Plane plane)
 }
 
 
+// -----------------------------
+// Brush → collision planes
+// -----------------------------
+
+// the parsed planes face into the brush in quake units, flip and convert them to meters so they line up with the mesh
+static BrushPlane *BuildPlanesFromBrush(Brush *brush)
+{
+    BrushPlane *planes = MemAlloc(sizeof(BrushPlane) * brush->planeCount);
+    for (int i = 0; i < brush->planeCount; i++) {
+        planes[i].normal = Vector3Negate(ConvertFromQuake(brush->planes[i].normal));
+        planes[i].d = -brush->planes[i].d * QUAKE_TO_METERS;
+    }
+    return planes;
+}
+
 // -----------------------------
 // Brush → Mesh
 // -----------------------------
@@ -520,7 +535,10 @@ Entity* LoadMapFile(const char *filename, int *modelCount) {
             TraceLog(LOG_INFO, "Model %d: %d triangles", i, m.triangleCount);
             Model mod = LoadModelFromMesh(m);
             entities[i].model = mod;
+            entities[i].planes = BuildPlanesFromBrush(&brushes[i]);
         }
+        else {entities[i].planes = NULL;}
+        entities[i].planeCount = brushes[i].planeCount;
         strcpy(entities[i].className,brushes[i].className);
         entities[i].hasOrigin = brushes[i].hasOrigin;
         entities[i].origin = brushes[i].origin;
@@ -2,6 +2,7 @@
 #define MAP_PARSER_H
 
 #include "raylib.h"
+#include "brush.h"
 
 
 typedef struct {
@@ -11,6 +12,8 @@ typedef struct {
     Vector3 origin;
     bool hasSubType;
     char subType[64];
+    int planeCount;
+    BrushPlane *planes; //brush faces in raylib space, NULL for point entities, whoever keeps the entity frees them
 } Entity;
 
 Entity* LoadMapFile(const char *filename, int *modelCount);
@@ -0,0 +1,446 @@
+#include "mesh_lod.h"
+#include "raylib.h"
+#include "raymath.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+//quadric edge collapse, half edge flavour: u is folded onto its neighbour v and v does not move
+//so every kept vertex keeps its own normal, uvs and skin weights, nothing is interpolated
+//vertices on an open edge or on a uv/normal seam (same position, split vertex) are never moved, that keeps seams closed
+
+//one candidate collapse in the heap, stale once either vertex changed since it was pushed
+typedef struct {
+    float cost;
+    int u;
+    int v;
+    unsigned int stampU;
+    unsigned int stampV;
+} Collapse;
+
+//working state of one SimplifyMesh call
+typedef struct {
+    const Mesh *src;
+    Vector3 *pos;
+    double *quadric; //10 per vertex, upper triangle of the symmetric 4x4
+    int *idx; //3 per triangle
+    bool *triDead;
+    int *cornerNext; //per corner, next corner of the same vertex, -1 ends the list
+    int *vertHead; //per vertex, first corner
+    bool *locked;
+    bool *vertDead;
+    unsigned int *stamp;
+    unsigned char *bone; //per vertex, strongest bone, 255 without skin
+    Collapse *heap;
+    int heapCount;
+    int heapCapacity;
+} Simplifier;
+
+static void HeapPush(Simplifier *s, Collapse c)
+{
+    if(s->heapCount == s->heapCapacity)
+    {
+        s->heapCapacity = s->heapCapacity > 0 ? s->heapCapacity * 2 : 1024;
+        s->heap = MemRealloc(s->heap, sizeof(Collapse) * s->heapCapacity);
+    }
+    int i = s->heapCount++;
+    while(i > 0)
+    {
+        int parent = (i - 1) / 2;
+        if(s->heap[parent].cost <= c.cost){break;}
+        s->heap[i] = s->heap[parent];
+        i = parent;
+    }
+    s->heap[i] = c;
+}
+
+static Collapse HeapPop(Simplifier *s)
+{
+    Collapse top = s->heap[0];
+    Collapse last = s->heap[--s->heapCount];
+    int i = 0;
+    while(true)
+    {
+        int child = i * 2 + 1;
+        if(child >= s->heapCount){break;}
+        if(child + 1 < s->heapCount && s->heap[child + 1].cost < s->heap[child].cost){child++;}
+        if(last.cost <= s->heap[child].cost){break;}
+        s->heap[i] = s->heap[child];
+        i = child;
+    }
+    if(s->heapCount > 0){s->heap[i] = last;}
+    return top;
+}
+
+static void AddPlaneQuadric(double *q, double a, double b, double c, double d, double w)
+{
+    q[0] += w * a * a; q[1] += w * a * b; q[2] += w * a * c; q[3] += w * a * d;
+    q[4] += w * b * b; q[5] += w * b * c; q[6] += w * b * d;
+    q[7] += w * c * c; q[8] += w * c * d;
+    q[9] += w * d * d;
+}
+
+static double QuadricError(const double *q, Vector3 p)
+{
+    double x = p.x, y = p.y, z = p.z;
+    return q[0] * x * x + 2 * q[1] * x * y + 2 * q[2] * x * z + 2 * q[3] * x
+         + q[4] * y * y + 2 * q[5] * y * z + 2 * q[6] * y
+         + q[7] * z * z + 2 * q[8] * z
+         + q[9];
+}
+
+static void PushCollapse(Simplifier *s, int u, int v)
+{
+    if(s->locked[u] || u == v){return;}
+    double q[10];
+    for(int k = 0; k < 10; k++){q[k] = s->quadric[u * 10 + k] + s->quadric[v * 10 + k];}
+    double cost = QuadricError(q, s->pos[v]);
+    if(cost < 0){cost = 0;}
+    if(s->bone[u] != s->bone[v]){cost += MESH_LOD_BONE_PENALTY * Vector3DistanceSqr(s->pos[u], s->pos[v]);}//keep the joints where the weights change
+    HeapPush(s, (Collapse){ (float)cost, u, v, s->stamp[u], s->stamp[v] });
+}
+
+//pushes both directions of every edge around v
+static void PushVertexEdges(Simplifier *s, int v)
+{
+    for(int c = s->vertHead[v]; c >= 0; c = s->cornerNext[c])
+    {
+        int t = c / 3;
+        if(s->triDead[t]){continue;}
+        for(int k = 0; k < 3; k++)
+        {
+            int w = s->idx[t * 3 + k];
+            if(w == v){continue;}
+            PushCollapse(s, v, w);
+            PushCollapse(s, w, v);
+        }
+    }
+}
+
+//other corners of the live triangles around v, at most max, -1 when there are more
+static int GatherNeighbours(const Simplifier *s, int v, int *out, int max)
+{
+    int count = 0;
+    for(int c = s->vertHead[v]; c >= 0; c = s->cornerNext[c])
+    {
+        int t = c / 3;
+        if(s->triDead[t]){continue;}
+        for(int k = 0; k < 3; k++)
+        {
+            int w = s->idx[t * 3 + k];
+            if(w == v){continue;}
+            bool seen = false;
+            for(int i = 0; i < count && !seen; i++){seen = out[i] == w;}
+            if(seen){continue;}
+            if(count == max){return -1;}
+            out[count++] = w;
+        }
+    }
+    return count;
+}
+
+//u and v still share a triangle, their neighbourhoods only meet on those triangles (no folded over duplicates),
+//and moving u onto v flips or squashes none of the triangles that survive
+static bool CanCollapse(const Simplifier *s, int u, int v)
+{
+    int nu[MESH_LOD_MAX_VALENCE];
+    int nv[MESH_LOD_MAX_VALENCE];
+    int countU = GatherNeighbours(s, u, nu, MESH_LOD_MAX_VALENCE);
+    int countV = GatherNeighbours(s, v, nv, MESH_LOD_MAX_VALENCE);
+    if(countU < 0 || countV < 0){return false;}
+    int common = 0;
+    for(int i = 0; i < countU; i++){for(int j = 0; j < countV; j++){if(nu[i] == nv[j]){common++;}}}
+    int shared = 0;
+    bool adjacent = false;
+    for(int c = s->vertHead[u]; c >= 0; c = s->cornerNext[c])
+    {
+        int t = c / 3;
+        if(s->triDead[t]){continue;}
+        const int *tri = &s->idx[t * 3];
+        if(tri[0] == v || tri[1] == v || tri[2] == v){adjacent = true; shared++; continue;}
+        Vector3 p[3] = { s->pos[tri[0]], s->pos[tri[1]], s->pos[tri[2]] };
+        Vector3 before = Vector3CrossProduct(Vector3Subtract(p[1], p[0]), Vector3Subtract(p[2], p[0]));
+        p[c % 3] = s->pos[v];
+        Vector3 after = Vector3CrossProduct(Vector3Subtract(p[1], p[0]), Vector3Subtract(p[2], p[0]));
+        float lenBefore = Vector3Length(before);
+        float lenAfter = Vector3Length(after);
+        if(lenAfter <= 1e-12f){return false;}
+        if(lenBefore > 1e-12f && Vector3DotProduct(before, after) < MESH_LOD_MAX_FLIP * lenBefore * lenAfter){return false;}
+    }
+    return adjacent && common == shared;
+}
+
+//folds u onto v, returns the number of triangles that went away
+static int DoCollapse(Simplifier *s, int u, int v)
+{
+    int removed = 0;
+    int last = -1;
+    for(int c = s->vertHead[u]; c >= 0; c = s->cornerNext[c])
+    {
+        last = c;
+        int t = c / 3;
+        if(s->triDead[t]){continue;}
+        const int *tri = &s->idx[t * 3];
+        if(tri[0] == v || tri[1] == v || tri[2] == v){s->triDead[t] = true; removed++; continue;}
+        s->idx[c] = v;
+    }
+    //u's corners now belong to v
+    if(last >= 0)
+    {
+        s->cornerNext[last] = s->vertHead[v];
+        s->vertHead[v] = s->vertHead[u];
+    }
+    s->vertHead[u] = -1;
+    s->vertDead[u] = true;
+    for(int k = 0; k < 10; k++){s->quadric[v * 10 + k] += s->quadric[u * 10 + k];}
+    s->stamp[v]++;
+    return removed;
+}
+
+static int CompareEdges(const void *a, const void *b)
+{
+    unsigned long long ea = *(const unsigned long long *)a;
+    unsigned long long eb = *(const unsigned long long *)b;
+    return ea < eb ? -1 : (ea > eb ? 1 : 0);
+}
+
+//qsort has no context pointer, so the positions for the seam sort live here
+static const Vector3 *sortPos = NULL;
+
+static int ComparePositions(const void *a, const void *b)
+{
+    Vector3 pa = sortPos[*(const int *)a];
+    Vector3 pb = sortPos[*(const int *)b];
+    if(pa.x != pb.x){return pa.x < pb.x ? -1 : 1;}
+    if(pa.y != pb.y){return pa.y < pb.y ? -1 : 1;}
+    if(pa.z != pb.z){return pa.z < pb.z ? -1 : 1;}
+    return 0;
+}
+
+//open edges, non manifold edges and split vertices never move
+static void LockBorders(Simplifier *s, int vertexCount, int triCount)
+{
+    unsigned long long *edges = MemAlloc(sizeof(unsigned long long) * triCount * 3);
+    for(int t = 0; t < triCount; t++)
+    {
+        for(int k = 0; k < 3; k++)
+        {
+            unsigned long long a = (unsigned int)s->idx[t * 3 + k];
+            unsigned long long b = (unsigned int)s->idx[t * 3 + (k + 1) % 3];
+            edges[t * 3 + k] = a < b ? (a << 32) | b : (b << 32) | a;
+        }
+    }
+    qsort(edges, triCount * 3, sizeof(unsigned long long), CompareEdges);
+    for(int i = 0; i < triCount * 3;)
+    {
+        int run = 1;
+        while(i + run < triCount * 3 && edges[i + run] == edges[i]){run++;}
+        if(run != 2)
+        {
+            s->locked[edges[i] >> 32] = true;
+            s->locked[edges[i] & 0xffffffffu] = true;
+        }
+        i += run;
+    }
+    MemFree(edges);
+
+    int *order = MemAlloc(sizeof(int) * vertexCount);
+    for(int i = 0; i < vertexCount; i++){order[i] = i;}
+    sortPos = s->pos;
+    qsort(order, vertexCount, sizeof(int), ComparePositions);
+    for(int i = 0; i < vertexCount;)
+    {
+        int run = 1;
+        while(i + run < vertexCount && ComparePositions(&order[i], &order[i + run]) == 0){run++;}
+        if(run > 1){for(int k = 0; k < run; k++){s->locked[order[i + k]] = true;}}
+        i += run;
+    }
+    MemFree(order);
+}
+
+//new mesh with roughly keep * the triangles of src, cpu side only, the caller uploads it
+//every attribute of a kept vertex is copied as is, bone ids and weights included
+Mesh SimplifyMesh(Mesh src, float keep)
+{
+    Mesh out = {0};
+    int vertexCount = src.vertexCount;
+    int triCount = src.indices ? src.triangleCount : vertexCount / 3;
+    if(vertexCount <= 0 || triCount <= 0 || vertexCount > 65535 || src.vertices == NULL){return out;}//indices are unsigned short
+
+    Simplifier s = {0};
+    s.src = &src;
+    s.pos = MemAlloc(sizeof(Vector3) * vertexCount);
+    s.quadric = MemAlloc(sizeof(double) * 10 * vertexCount);
+    s.idx = MemAlloc(sizeof(int) * triCount * 3);
+    s.triDead = MemAlloc(sizeof(bool) * triCount);
+    s.cornerNext = MemAlloc(sizeof(int) * triCount * 3);
+    s.vertHead = MemAlloc(sizeof(int) * vertexCount);
+    s.locked = MemAlloc(sizeof(bool) * vertexCount);
+    s.vertDead = MemAlloc(sizeof(bool) * vertexCount);
+    s.stamp = MemAlloc(sizeof(unsigned int) * vertexCount);
+    s.bone = MemAlloc(sizeof(unsigned char) * vertexCount);
+    memset(s.quadric, 0, sizeof(double) * 10 * vertexCount);
+    memset(s.triDead, 0, sizeof(bool) * triCount);
+    memset(s.locked, 0, sizeof(bool) * vertexCount);
+    memset(s.vertDead, 0, sizeof(bool) * vertexCount);
+    memset(s.stamp, 0, sizeof(unsigned int) * vertexCount);
+    for(int i = 0; i < vertexCount; i++)
+    {
+        s.pos[i] = (Vector3){ src.vertices[i * 3], src.vertices[i * 3 + 1], src.vertices[i * 3 + 2] };
+        s.vertHead[i] = -1;
+        s.bone[i] = 255;
+        if(src.boneIds && src.boneWeights)
+        {
+            int best = 0;
+            for(int j = 1; j < 4; j++){if(src.boneWeights[i * 4 + j] > src.boneWeights[i * 4 + best]){best = j;}}
+            s.bone[i] = src.boneIds[i * 4 + best];
+        }
+    }
+    for(int c = 0; c < triCount * 3; c++)
+    {
+        s.idx[c] = src.indices ? src.indices[c] : c;
+        s.cornerNext[c] = s.vertHead[s.idx[c]];
+        s.vertHead[s.idx[c]] = c;
+    }
+    //plane of every triangle into its corners, area weighted
+    for(int t = 0; t < triCount; t++)
+    {
+        const int *tri = &s.idx[t * 3];
+        Vector3 n = Vector3CrossProduct(Vector3Subtract(s.pos[tri[1]], s.pos[tri[0]]), Vector3Subtract(s.pos[tri[2]], s.pos[tri[0]]));
+        float len = Vector3Length(n);
+        if(len <= 1e-12f){continue;}
+        n = Vector3Scale(n, 1.0f / len);
+        double d = -Vector3DotProduct(n, s.pos[tri[0]]);
+        for(int k = 0; k < 3; k++){AddPlaneQuadric(&s.quadric[tri[k] * 10], n.x, n.y, n.z, d, len * 0.5);}
+    }
+    LockBorders(&s, vertexCount, triCount);
+    for(int v = 0; v < vertexCount; v++){PushVertexEdges(&s, v);}
+
+    int live = triCount;
+    int target = (int)(triCount * keep);
+    if(target < MESH_LOD_MIN_TRIANGLES){target = MESH_LOD_MIN_TRIANGLES;}
+    while(live > target && s.heapCount > 0)
+    {
+        Collapse c = HeapPop(&s);
+        if(s.vertDead[c.u] || s.vertDead[c.v] || c.stampU != s.stamp[c.u] || c.stampV != s.stamp[c.v]){continue;}
+        if(!CanCollapse(&s, c.u, c.v)){continue;}
+        live -= DoCollapse(&s, c.u, c.v);
+        PushVertexEdges(&s, c.v);
+    }
+
+    //compact what is left, vertices keep their order
+    int *remap = MemAlloc(sizeof(int) * vertexCount);
+    for(int i = 0; i < vertexCount; i++){remap[i] = -1;}
+    int used = 0;
+    for(int t = 0; t < triCount; t++)
+    {
+        if(s.triDead[t]){continue;}
+        for(int k = 0; k < 3; k++){remap[s.idx[t * 3 + k]] = 0;}
+    }
+    for(int i = 0; i < vertexCount; i++){if(remap[i] == 0){remap[i] = used++;}}
+
+    out.vertexCount = used;
+    out.triangleCount = live;
+    out.vertices = MemAlloc(sizeof(float) * used * 3);
+    if(src.normals){out.normals = MemAlloc(sizeof(float) * used * 3);}
+    if(src.texcoords){out.texcoords = MemAlloc(sizeof(float) * used * 2);}
+    if(src.texcoords2){out.texcoords2 = MemAlloc(sizeof(float) * used * 2);}
+    if(src.tangents){out.tangents = MemAlloc(sizeof(float) * used * 4);}
+    if(src.colors){out.colors = MemAlloc(sizeof(unsigned char) * used * 4);}
+    if(src.boneIds){out.boneIds = MemAlloc(sizeof(unsigned char) * used * 4);}
+    if(src.boneWeights){out.boneWeights = MemAlloc(sizeof(float) * used * 4);}
+    for(int i = 0; i < vertexCount; i++)
+    {
+        int o = remap[i];
+        if(o < 0){continue;}
+        memcpy(&out.vertices[o * 3], &src.vertices[i * 3], sizeof(float) * 3);
+        if(src.normals){memcpy(&out.normals[o * 3], &src.normals[i * 3], sizeof(float) * 3);}
+        if(src.texcoords){memcpy(&out.texcoords[o * 2], &src.texcoords[i * 2], sizeof(float) * 2);}
+        if(src.texcoords2){memcpy(&out.texcoords2[o * 2], &src.texcoords2[i * 2], sizeof(float) * 2);}
+        if(src.tangents){memcpy(&out.tangents[o * 4], &src.tangents[i * 4], sizeof(float) * 4);}
+        if(src.colors){memcpy(&out.colors[o * 4], &src.colors[i * 4], sizeof(unsigned char) * 4);}
+        if(src.boneIds){memcpy(&out.boneIds[o * 4], &src.boneIds[i * 4], sizeof(unsigned char) * 4);}
+        if(src.boneWeights){memcpy(&out.boneWeights[o * 4], &src.boneWeights[i * 4], sizeof(float) * 4);}
+    }
+    out.indices = MemAlloc(sizeof(unsigned short) * live * 3);
+    int n = 0;
+    for(int t = 0; t < triCount; t++)
+    {
+        if(s.triDead[t]){continue;}
+        for(int k = 0; k < 3; k++){out.indices[n++] = (unsigned short)remap[s.idx[t * 3 + k]];}
+    }
+
+    MemFree(remap);
+    MemFree(s.pos);
+    MemFree(s.quadric);
+    MemFree(s.idx);
+    MemFree(s.triDead);
+    MemFree(s.cornerNext);
+    MemFree(s.vertHead);
+    MemFree(s.locked);
+    MemFree(s.vertDead);
+    MemFree(s.stamp);
+    MemFree(s.bone);
+    if(s.heap){MemFree(s.heap);}
+    return out;
+}
+
+//simplified copies of every mesh, uploaded, materials, bones and bind pose stay the model's
+ModelLods BuildModelLods(Model model)
+{
+    ModelLods m = {0};
+    m.lods[0] = model;
+    const float keep[MESH_LOD_LEVELS] = { 1.0f, MESH_LOD_KEEP_1, MESH_LOD_KEEP_2 };
+    int triangles[MESH_LOD_LEVELS] = {0};
+    for(int i = 0; i < model.meshCount; i++){triangles[0] += model.meshes[i].triangleCount;}
+    for(int lod = 1; lod < MESH_LOD_LEVELS; lod++)
+    {
+        Model l = model;
+        l.meshes = MemAlloc(sizeof(Mesh) * model.meshCount);
+        bool ok = true;
+        for(int i = 0; i < model.meshCount && ok; i++)
+        {
+            l.meshes[i] = SimplifyMesh(model.meshes[i], keep[lod]);
+            ok = l.meshes[i].vertexCount > 0;
+        }
+        if(!ok)//a mesh too big for unsigned short indices, this level draws full detail
+        {
+            for(int i = 0; i < model.meshCount; i++){if(l.meshes[i].vertexCount > 0){UnloadMesh(l.meshes[i]);}}
+            MemFree(l.meshes);
+            l = model;
+        }
+        else
+        {
+            for(int i = 0; i < model.meshCount; i++){UploadMesh(&l.meshes[i], false);}
+        }
+        for(int i = 0; i < model.meshCount; i++){triangles[lod] += l.meshes[i].triangleCount;}
+        m.lods[lod] = l;
+    }
+    printf("mesh lods: %d / %d / %d triangles\n", triangles[0], triangles[1], triangles[2]);
+    return m;
+}
+
+int PickMeshLod(float dist)
+{
+    if(dist < MESH_LOD_DIST_1){return 0;}
+    if(dist < MESH_LOD_DIST_2){return 1;}
+    return 2;
+}
+
+Model GetModelLod(const ModelLods *m, float dist)
+{
+    return m->lods[PickMeshLod(dist)];
+}
+
+//only the simplified levels, lods[0] goes with the level's models
+void UnloadModelLods(ModelLods *m)
+{
+    for(int lod = 1; lod < MESH_LOD_LEVELS; lod++)
+    {
+        if(m->lods[lod].meshes == NULL || m->lods[lod].meshes == m->lods[0].meshes){continue;}
+        for(int i = 0; i < m->lods[lod].meshCount; i++){UnloadMesh(m->lods[lod].meshes[i]);}
+        MemFree(m->lods[lod].meshes);
+    }
+    *m = (ModelLods){0};
+}
@@ -0,0 +1,30 @@
+#ifndef MESH_LOD_H
+#define MESH_LOD_H
+
+#include "raylib.h"
+
+//constants
+#define MESH_LOD_LEVELS 3 //full detail plus two simplified levels
+#define MESH_LOD_DIST_1 25.0f //meters, past this the first simplified level is drawn
+#define MESH_LOD_DIST_2 50.0f //and past this the second, the view distance is 100
+#define MESH_LOD_KEEP_1 0.5f //share of the triangles each simplified level keeps
+#define MESH_LOD_KEEP_2 0.2f
+#define MESH_LOD_MIN_TRIANGLES 16 //never simplify a mesh below this
+#define MESH_LOD_MAX_FLIP 0.2f //cos of the largest normal turn a collapse may cause on its triangles
+#define MESH_LOD_MAX_VALENCE 32 //vertices with more neighbours than this are left alone
+#define MESH_LOD_BONE_PENALTY 4.0f //extra cost, times the edge length squared, for collapsing across bones
+
+//structs
+//lods[0] is the loaded model, borrowed, the rest own their meshes and share everything else with it
+typedef struct {
+    Model lods[MESH_LOD_LEVELS];
+} ModelLods;
+
+//functions
+Mesh SimplifyMesh(Mesh src, float keep);
+ModelLods BuildModelLods(Model model);
+int PickMeshLod(float dist);
+Model GetModelLod(const ModelLods *m, float dist);
+void UnloadModelLods(ModelLods *m);
+
+#endif // MESH_LOD_H
@@ -0,0 +1,227 @@
+#include "occlusion.h"
+#include "raylib.h"
+#include "raymath.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#if defined(COLLISION_SIMD_SSE2)
+    #include <emmintrin.h>
+#elif defined(COLLISION_SIMD_NEON)
+    #include <arm_neon.h>
+#endif
+
+//a point after the view projection, w not divided out yet
+typedef struct {
+    float x;
+    float y;
+    float z;
+    float w;
+} ClipVertex;
+
+static ClipVertex TransformClip(Matrix m, Vector3 p)
+{
+    return (ClipVertex){
+        m.m0 * p.x + m.m4 * p.y + m.m8 * p.z + m.m12,
+        m.m1 * p.x + m.m5 * p.y + m.m9 * p.z + m.m13,
+        m.m2 * p.x + m.m6 * p.y + m.m10 * p.z + m.m14,
+        m.m3 * p.x + m.m7 * p.y + m.m11 * p.z + m.m15
+    };
+}
+
+//pixel x, pixel y and ndc z
+static Vector3 ToScreen(ClipVertex c)
+{
+    float inv = 1.0f / c.w;
+    return (Vector3){
+        (c.x * inv * 0.5f + 0.5f) * OCCLUSION_WIDTH,
+        (0.5f - c.y * inv * 0.5f) * OCCLUSION_HEIGHT,
+        c.z * inv
+    };
+}
+
+void InitOcclusionBuffer(OcclusionBuffer *o)
+{
+    memset(o, 0, sizeof(OcclusionBuffer));
+    o->depth = MemAlloc(sizeof(float) * OCCLUSION_WIDTH * OCCLUSION_HEIGHT);
+    BeginOcclusionFrame(o, MatrixIdentity());
+}
+
+void BeginOcclusionFrame(OcclusionBuffer *o, Matrix viewProj)
+{
+    o->viewProj = viewProj;
+    o->occluderCount = 0;
+    for(int i = 0; i < OCCLUSION_WIDTH * OCCLUSION_HEIGHT; i++){o->depth[i] = 1.0f;}
+}
+
+//keeps the nearest depth of one screen space triangle, pixel centres only so edges stay conservative
+//four pixels of a row at a time, rows start on a multiple of 4 so the groups never leave the buffer
+static void RasterTriangle(float *depth, Vector3 a, Vector3 b, Vector3 c)
+{
+    float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    if(fabsf(area) < 1e-6f){return;}
+    if(area < 0){Vector3 t = b; b = c; c = t; area = -area;}
+    int minX = (int)floorf(fminf(a.x, fminf(b.x, c.x)));
+    int maxX = (int)ceilf(fmaxf(a.x, fmaxf(b.x, c.x)));
+    int minY = (int)floorf(fminf(a.y, fminf(b.y, c.y)));
+    int maxY = (int)ceilf(fmaxf(a.y, fmaxf(b.y, c.y)));
+    if(minX < 0){minX = 0;}
+    if(minY < 0){minY = 0;}
+    if(maxX > OCCLUSION_WIDTH - 1){maxX = OCCLUSION_WIDTH - 1;}
+    if(maxY > OCCLUSION_HEIGHT - 1){maxY = OCCLUSION_HEIGHT - 1;}
+    if(minX > maxX || minY > maxY){return;}
+    minX &= ~3;
+
+    //edge functions, e0 weights a, e1 weights b, e2 weights c, all positive inside
+    float dx0 = -(c.y - b.y), dy0 = c.x - b.x;
+    float dx1 = -(a.y - c.y), dy1 = a.x - c.x;
+    float dx2 = -(b.y - a.y), dy2 = b.x - a.x;
+    float px = minX + 0.5f;
+    float invArea = 1.0f / area;
+    //depth as a plane over the pixels, z = z0 + zx * x + zy * y relative to the first pixel of the row
+    float za = a.z * invArea, zb = b.z * invArea, zc = c.z * invArea;
+    for(int y = minY; y <= maxY; y++)
+    {
+        float py = y + 0.5f;
+        float e0 = dy0 * (py - b.y) + dx0 * (px - b.x);
+        float e1 = dy1 * (py - c.y) + dx1 * (px - c.x);
+        float e2 = dy2 * (py - a.y) + dx2 * (px - a.x);
+        float *row = &depth[y * OCCLUSION_WIDTH];
+#if defined(COLLISION_SIMD_SSE2)
+        __m128 lane = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+        __m128 w0 = _mm_add_ps(_mm_set1_ps(e0), _mm_mul_ps(lane, _mm_set1_ps(dx0)));
+        __m128 w1 = _mm_add_ps(_mm_set1_ps(e1), _mm_mul_ps(lane, _mm_set1_ps(dx1)));
+        __m128 w2 = _mm_add_ps(_mm_set1_ps(e2), _mm_mul_ps(lane, _mm_set1_ps(dx2)));
+        __m128 step0 = _mm_set1_ps(dx0 * 4.0f), step1 = _mm_set1_ps(dx1 * 4.0f), step2 = _mm_set1_ps(dx2 * 4.0f);
+        __m128 vza = _mm_set1_ps(za), vzb = _mm_set1_ps(zb), vzc = _mm_set1_ps(zc), zero = _mm_setzero_ps();
+        for(int x = minX; x <= maxX; x += 4)
+        {
+            __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(w0, zero), _mm_cmpge_ps(w1, zero)), _mm_cmpge_ps(w2, zero));
+            if(_mm_movemask_ps(inside))
+            {
+                __m128 z = _mm_add_ps(_mm_add_ps(_mm_mul_ps(w0, vza), _mm_mul_ps(w1, vzb)), _mm_mul_ps(w2, vzc));
+                __m128 old = _mm_loadu_ps(&row[x]);
+                __m128 nearest = _mm_min_ps(old, z);
+                _mm_storeu_ps(&row[x], _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, old)));
+            }
+            w0 = _mm_add_ps(w0, step0);
+            w1 = _mm_add_ps(w1, step1);
+            w2 = _mm_add_ps(w2, step2);
+        }
+#elif defined(COLLISION_SIMD_NEON)
+        const float laneInit[4] = {0.0f, 1.0f, 2.0f, 3.0f};
+        float32x4_t lane = vld1q_f32(laneInit);
+        float32x4_t w0 = vmlaq_n_f32(vdupq_n_f32(e0), lane, dx0);
+        float32x4_t w1 = vmlaq_n_f32(vdupq_n_f32(e1), lane, dx1);
+        float32x4_t w2 = vmlaq_n_f32(vdupq_n_f32(e2), lane, dx2);
+        float32x4_t step0 = vdupq_n_f32(dx0 * 4.0f), step1 = vdupq_n_f32(dx1 * 4.0f), step2 = vdupq_n_f32(dx2 * 4.0f);
+        float32x4_t zero = vdupq_n_f32(0.0f);
+        for(int x = minX; x <= maxX; x += 4)
+        {
+            uint32x4_t inside = vandq_u32(vandq_u32(vcgeq_f32(w0, zero), vcgeq_f32(w1, zero)), vcgeq_f32(w2, zero));
+            uint32x2_t any = vorr_u32(vget_low_u32(inside), vget_high_u32(inside));
+            if(vget_lane_u32(vpmax_u32(any, any), 0))
+            {
+                float32x4_t z = vmlaq_n_f32(vmlaq_n_f32(vmulq_n_f32(w0, za), w1, zb), w2, zc);
+                float32x4_t old = vld1q_f32(&row[x]);
+                vst1q_f32(&row[x], vbslq_f32(inside, vminq_f32(old, z), old));
+            }
+            w0 = vaddq_f32(w0, step0);
+            w1 = vaddq_f32(w1, step1);
+            w2 = vaddq_f32(w2, step2);
+        }
+#else
+        for(int x = minX; x <= maxX; x += 4)
+        {
+            for(int k = 0; k < 4; k++)
+            {
+                float w0 = e0 + dx0 * k, w1 = e1 + dx1 * k, w2 = e2 + dx2 * k;
+                if(w0 < 0 || w1 < 0 || w2 < 0){continue;}
+                float z = w0 * za + w1 * zb + w2 * zc;
+                if(z < row[x + k]){row[x + k] = z;}
+            }
+            e0 += dx0 * 4.0f;
+            e1 += dx1 * 4.0f;
+            e2 += dx2 * 4.0f;
+        }
+#endif
+    }
+}
+
+//the part of a clip space point between a and b where w reaches the near plane
+static ClipVertex ClipNear(ClipVertex a, ClipVertex b)
+{
+    float t = (OCCLUSION_NEAR_W - a.w) / (b.w - a.w);
+    return (ClipVertex){ a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t, OCCLUSION_NEAR_W };
+}
+
+//brush triangles into the buffer, clipped against the near plane, anything else the raster clamps away
+void DrawOccluderTris(OcclusionBuffer *o, const CollisionTri *tris, int count)
+{
+    for(int i = 0; i < count; i++)
+    {
+        ClipVertex in[3] = {
+            TransformClip(o->viewProj, tris[i].v0),
+            TransformClip(o->viewProj, tris[i].v1),
+            TransformClip(o->viewProj, tris[i].v2)
+        };
+        ClipVertex poly[4];
+        int n = 0;
+        for(int k = 0; k < 3; k++)
+        {
+            ClipVertex cur = in[k];
+            ClipVertex next = in[(k + 1) % 3];
+            bool curIn = cur.w >= OCCLUSION_NEAR_W;
+            bool nextIn = next.w >= OCCLUSION_NEAR_W;
+            if(curIn){poly[n++] = cur;}
+            if(curIn != nextIn){poly[n++] = ClipNear(cur, next);}
+        }
+        if(n < 3){continue;}
+        Vector3 s0 = ToScreen(poly[0]);
+        for(int k = 1; k + 1 < n; k++){RasterTriangle(o->depth, s0, ToScreen(poly[k]), ToScreen(poly[k + 1]));}
+    }
+    o->occluderCount++;
+}
+
+//true when every pixel the box covers already has an occluder in front of the box's nearest point
+bool IsBoxOccluded(OcclusionBuffer *o, BoundingBox box)
+{
+    if(o->occluderCount == 0){return false;}
+    o->tested++;
+    float minX = OCCLUSION_WIDTH, minY = OCCLUSION_HEIGHT, maxX = 0, maxY = 0, minZ = 1.0f;
+    for(int i = 0; i < 8; i++)
+    {
+        Vector3 corner = { (i & 1) ? box.max.x : box.min.x, (i & 2) ? box.max.y : box.min.y, (i & 4) ? box.max.z : box.min.z };
+        ClipVertex c = TransformClip(o->viewProj, corner);
+        if(c.w < OCCLUSION_NEAR_W){return false;}//reaches past the near plane, too close to tell
+        Vector3 s = ToScreen(c);
+        minX = fminf(minX, s.x); maxX = fmaxf(maxX, s.x);
+        minY = fminf(minY, s.y); maxY = fmaxf(maxY, s.y);
+        minZ = fminf(minZ, s.z);
+    }
+    //one pixel of slack all round, the occluders only cover the pixel centres they contain
+    int x0 = (int)floorf(minX) - 1, x1 = (int)ceilf(maxX) + 1;
+    int y0 = (int)floorf(minY) - 1, y1 = (int)ceilf(maxY) + 1;
+    if(x1 < 0 || y1 < 0 || x0 >= OCCLUSION_WIDTH || y0 >= OCCLUSION_HEIGHT){return false;}//off screen, frustum culling's job
+    if(x0 < 0){x0 = 0;}
+    if(y0 < 0){y0 = 0;}
+    if(x1 > OCCLUSION_WIDTH - 1){x1 = OCCLUSION_WIDTH - 1;}
+    if(y1 > OCCLUSION_HEIGHT - 1){y1 = OCCLUSION_HEIGHT - 1;}
+    for(int y = y0; y <= y1; y++)
+    {
+        const float *row = &o->depth[y * OCCLUSION_WIDTH];
+        for(int x = x0; x <= x1; x++)
+        {
+            if(row[x] >= minZ){return false;}
+        }
+    }
+    o->culled++;
+    return true;
+}
+
+void UnloadOcclusionBuffer(OcclusionBuffer *o)
+{
+    printf("occlusion: %ld of %ld boxes hidden behind brushes\n", o->culled, o->tested);
+    if(o->depth){MemFree(o->depth);}
+    memset(o, 0, sizeof(OcclusionBuffer));
+}
@@ -0,0 +1,32 @@
+#ifndef OCCLUSION_H
+#define OCCLUSION_H
+
+#include "raylib.h"
+#include "collision_mesh.h" //CollisionTri, and COLLISION_SIMD_* picks the raster kernel
+
+//constants
+#define OCCLUSION_WIDTH 256 //depth buffer size, a multiple of 4, same 4:3 as the window
+#define OCCLUSION_HEIGHT 192
+#define OCCLUSION_NEAR_W 0.1f //clip w of the near plane, occluder triangles are clipped against it
+#define OCCLUSION_MAX_OCCLUDERS 48 //nearest brushes drawn into the buffer each frame
+#define OCCLUSION_OCCLUDER_DIST 60.0f //meters, brushes further away than this are not drawn as occluders
+#define OCCLUSION_MIN_SIZE 2.0f //meters, brushes need one side at least this long to be worth drawing
+
+//structs
+//low resolution depth of the nearest brushes, boxes fully behind it are not drawn
+typedef struct {
+    float *depth; //OCCLUSION_WIDTH * OCCLUSION_HEIGHT, ndc z of the nearest occluder, 1 where there is none
+    Matrix viewProj;
+    int occluderCount; //drawn this frame, 0 turns the test off
+    long tested;
+    long culled;
+} OcclusionBuffer;
+
+//functions
+void InitOcclusionBuffer(OcclusionBuffer *o);
+void BeginOcclusionFrame(OcclusionBuffer *o, Matrix viewProj);
+void DrawOccluderTris(OcclusionBuffer *o, const CollisionTri *tris, int count);
+bool IsBoxOccluded(OcclusionBuffer *o, BoundingBox box);
+void UnloadOcclusionBuffer(OcclusionBuffer *o);
+
+#endif // OCCLUSION_H
@@ -0,0 +1,262 @@
+#include "pvs.h"
+#include "job_pool.h"
+#include "raylib.h"
+#include "raymath.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+static int ClampInt(int v, int lo, int hi)
+{
+    if(v < lo){return lo;}
+    if(v > hi){return hi;}
+    return v;
+}
+
+static void SetVisible(Pvs *p, int a, int b)
+{
+    p->bits[a * p->rowBytes + (b >> 3)] |= (unsigned char)(1 << (b & 7));
+}
+
+//one row of the upper triangle per job, everything shared is read only
+typedef struct {
+    Pvs *p;
+    const RaycastScene *scene;
+    const Vector3 *samples;
+    const int *sampleCount;
+    long *rowVisible; //per row, visible pairs
+    long *rowTraced; //pairs the rays decided, the rest are visible by rule
+    long *rowTracedVisible;
+} PvsRowJobs;
+
+//true when p is inside any brush of the scene, sample points there are useless
+static bool IsPointInSolid(RaycastScene *scene, Vector3 p)
+{
+    int near[64];
+    BoundingBox probe = { Vector3SubtractValue(p, 0.01f), Vector3AddValue(p, 0.01f) };
+    int nearCount = QueryBvh(&scene->bvh, probe, near, 64);
+    for(int i = 0; i < nearCount; i++)
+    {
+        const RayPrim *prim = &scene->prims[near[i]];
+        if(prim->planeCount > 0 && CheckPointInBrush(prim->planes, prim->planeCount, p)){return true;}
+    }
+    return false;
+}
+
+//a top of something that is not a floor, a wall or a crate, counts when there is a floor within a jump below it close by
+static bool IsTopReachable(GroundField *ground, const bool *floorObj, float x, float y, float z)
+{
+    BoundingBox reach = { { x - PVS_CLIMB_REACH, y - PVS_CLIMB_HEIGHT, z - PVS_CLIMB_REACH }, { x + PVS_CLIMB_REACH, y - 0.01f, z + PVS_CLIMB_REACH } };
+    int near[GROUND_QUERY_MAX];
+    int nearCount = QueryWorldGrid(&ground->grid, reach, near, GROUND_QUERY_MAX);
+    for(int n = 0; n < nearCount; n++)
+    {
+        if(floorObj[ground->surfaces[near[n]].obj]){return true;}
+    }
+    return false;
+}
+
+//eye points a player or enemy could be at in the cell, crouched, standing and jumping on every floor layer under each sample column
+//tops of objects marked in floorObj count, and any other top that can be jumped onto from one, -1 when there are more than PVS_MAX_SAMPLES
+static int GatherCellSamples(const Pvs *p, RaycastScene *scene, GroundField *ground, const bool *floorObj, BoundingBox bounds, int cell, Vector3 *out)
+{
+    static const float eyeHeights[3] = { PVS_EYE_CROUCH, PVS_EYE_STAND, PVS_EYE_JUMP };
+    int count = 0;
+    int cx = cell % p->cols;
+    int cz = cell / p->cols;
+    for(int s = 0; s < PVS_SAMPLE_COLUMNS * PVS_SAMPLE_COLUMNS; s++)
+    {
+        float x = p->minX + (cx + (s % PVS_SAMPLE_COLUMNS + 0.5f) / PVS_SAMPLE_COLUMNS) * p->cellSize;
+        float z = p->minZ + (cz + (s / PVS_SAMPLE_COLUMNS + 0.5f) / PVS_SAMPLE_COLUMNS) * p->cellSize;
+        BoundingBox column = { { x - 0.01f, bounds.min.y - 1.0f, z - 0.01f }, { x + 0.01f, bounds.max.y + 1.0f, z + 0.01f } };
+        int near[GROUND_QUERY_MAX];
+        int nearCount = QueryWorldGrid(&ground->grid, column, near, GROUND_QUERY_MAX);
+        //top down, a floor within PVS_LAYER_GAP of the last kept one is the same layer
+        float lastY = INFINITY;
+        while(true)
+        {
+            float bestY = -INFINITY;
+            for(int n = 0; n < nearCount; n++)
+            {
+                const GroundSurface *g = &ground->surfaces[near[n]];
+                float y = g->a * x + g->b * z + g->c;
+                if(y > lastY - PVS_LAYER_GAP || y <= bestY){continue;}
+                if(floorObj[g->obj] || IsTopReachable(ground, floorObj, x, y, z)){bestY = y;}
+            }
+            if(bestY == -INFINITY){break;}
+            for(int h = 0; h < 3; h++)
+            {
+                Vector3 eye = { x, bestY + eyeHeights[h], z };
+                if(IsPointInSolid(scene, eye)){continue;}
+                if(count == PVS_MAX_SAMPLES){return -1;}
+                out[count++] = eye;
+            }
+            lastY = bestY;
+        }
+    }
+    return count;
+}
+
+//every sample pair, RAY_PACKET_MAX sight rays at a time, the rays between two cells start and end close together
+static bool SamplesSeeEachOther(RaycastScene *scene, const Vector3 *a, int aCount, const Vector3 *b, int bCount)
+{
+    Ray rays[RAY_PACKET_MAX];
+    float lens[RAY_PACKET_MAX];
+    int n = 0;
+    int total = aCount * bCount;
+    for(int k = 0; k < total; k++)
+    {
+        Vector3 from = a[k / bCount];
+        Vector3 d = Vector3Subtract(b[k % bCount], from);
+        float len = Vector3Length(d);
+        if(len < 1e-4f){return true;}
+        rays[n] = (Ray){ from, Vector3Scale(d, 1.0f / len) };
+        lens[n++] = len;
+        if(n < RAY_PACKET_MAX && k < total - 1){continue;}
+        RayPacket p = MakeRayPacket(rays, n, 0.0f);
+        for(int i = 0; i < n; i++){p.tMax[i] = lens[i];}
+        RayHit hits[RAY_PACKET_MAX];
+        RaycastPacketClosest(scene, &p, p.laneMask, hits);
+        for(int i = 0; i < n; i++)
+        {
+            if(!hits[i].hit){return true;}
+        }
+        n = 0;
+    }
+    return false;
+}
+
+static void BuildPvsRow(void *ctx, int a)
+{
+    PvsRowJobs *j = ctx;
+    Pvs *p = j->p;
+    RaycastScene scene = *j->scene; //own copy, queries write their test count into it
+    int ax = a % p->cols, az = a / p->cols;
+    SetVisible(p, a, a);
+    for(int b = a + 1; b < p->cellCount; b++)
+    {
+        int bx = b % p->cols, bz = b / p->cols;
+        float dist = p->cellSize * sqrtf((float)((ax - bx) * (ax - bx) + (az - bz) * (az - bz)));
+        bool visible = abs(ax - bx) <= 1 && abs(az - bz) <= 1;
+        if(!visible){visible = j->sampleCount[a] <= 0 || j->sampleCount[b] <= 0;}
+        if(!visible){visible = dist > PVS_MAX_DIST;}
+        if(!visible)
+        {
+            visible = SamplesSeeEachOther(&scene, &j->samples[a * PVS_MAX_SAMPLES], j->sampleCount[a], &j->samples[b * PVS_MAX_SAMPLES], j->sampleCount[b]);
+            j->rowTraced[a]++;
+            j->rowTracedVisible[a] += visible;
+        }
+        if(visible){SetVisible(p, a, b); j->rowVisible[a]++;}
+    }
+}
+
+//cells and their potentially visible sets over bounds, worked out with sight rays between floor samples
+//neighbours and far pairs stay visible, and so does every pair with a cell that has no samples or too many
+//those are cells the samples missed (a ledge between columns, a floor fully under brushes), it has to be conservative
+Pvs BuildPvs(RaycastScene *scene, GroundField *ground, const bool *floorObj, BoundingBox bounds)
+{
+    Pvs p = {0};
+    if(scene->primCount == 0 || ground->surfaceCount == 0){return p;}
+    clock_t startClock = clock();
+
+    p.minX = bounds.min.x;
+    p.minZ = bounds.min.z;
+    p.cellSize = PVS_CELL_SIZE;
+    p.cols = (int)ceilf((bounds.max.x - bounds.min.x) / p.cellSize) + 1;
+    p.rows = (int)ceilf((bounds.max.z - bounds.min.z) / p.cellSize) + 1;
+    while(p.cols * p.rows > PVS_MAX_CELLS)
+    {
+        p.cellSize *= 2.0f;
+        p.cols = (int)ceilf((bounds.max.x - bounds.min.x) / p.cellSize) + 1;
+        p.rows = (int)ceilf((bounds.max.z - bounds.min.z) / p.cellSize) + 1;
+    }
+    p.cellCount = p.cols * p.rows;
+    p.rowBytes = (p.cellCount + 7) / 8;
+    p.bits = MemAlloc(p.rowBytes * p.cellCount);
+    p.cellTop = MemAlloc(sizeof(float) * p.cellCount);
+
+    Vector3 *samples = MemAlloc(sizeof(Vector3) * p.cellCount * PVS_MAX_SAMPLES);
+    int *sampleCount = MemAlloc(sizeof(int) * p.cellCount);
+    int totalSamples = 0;
+    int openCells = 0;
+    for(int c = 0; c < p.cellCount; c++)
+    {
+        sampleCount[c] = GatherCellSamples(&p, scene, ground, floorObj, bounds, c, &samples[c * PVS_MAX_SAMPLES]);
+        p.cellTop[c] = sampleCount[c] > 0 ? -INFINITY : INFINITY;
+        for(int s = 0; s < sampleCount[c]; s++){p.cellTop[c] = fmaxf(p.cellTop[c], samples[c * PVS_MAX_SAMPLES + s].y);}
+        if(sampleCount[c] > 0){totalSamples += sampleCount[c];}
+        else{openCells++;}
+    }
+
+    //upper triangle across the job pool, then mirrored
+    long *rowStats = MemAlloc(sizeof(long) * p.cellCount * 3);
+    PvsRowJobs jobs = { &p, scene, samples, sampleCount, rowStats, rowStats + p.cellCount, rowStats + 2 * p.cellCount };
+    RunJobs(BuildPvsRow, &jobs, p.cellCount);
+    long visiblePairs = 0;
+    long sampledPairs = 0;
+    long sampledVisible = 0;
+    for(int a = 0; a < p.cellCount; a++)
+    {
+        visiblePairs += jobs.rowVisible[a];
+        sampledPairs += jobs.rowTraced[a];
+        sampledVisible += jobs.rowTracedVisible[a];
+        for(int b = a + 1; b < p.cellCount; b++)
+        {
+            if(IsPvsCellVisible(&p, a, b)){SetVisible(&p, b, a);}
+        }
+    }
+    MemFree(rowStats);
+    MemFree(samples);
+    MemFree(sampleCount);
+
+    long pairs = (long)p.cellCount * (p.cellCount - 1) / 2;
+    printf("pvs: %dx%d cells of %.1fm, %d samples, %d cells unsampled, %.1f%% of cell pairs visible (%.1f%% of %ld traced), %.2fs cpu\n",
+        p.cols, p.rows, p.cellSize, totalSamples, openCells, pairs > 0 ? 100.0 * visiblePairs / pairs : 100.0,
+        sampledPairs > 0 ? 100.0 * sampledVisible / sampledPairs : 100.0, sampledPairs, (double)(clock() - startClock) / CLOCKS_PER_SEC);
+    return p;
+}
+
+//cell under pos, positions off the grid clamp to the edge
+//-1 without a pvs, or when pos is above every sample of its cell (on a roof, a yeti mid jump), the samples say nothing about what it sees
+int GetPvsCell(const Pvs *p, Vector3 pos)
+{
+    if(p->cellCount == 0){return -1;}
+    int x = ClampInt((int)floorf((pos.x - p->minX) / p->cellSize), 0, p->cols - 1);
+    int z = ClampInt((int)floorf((pos.z - p->minZ) / p->cellSize), 0, p->rows - 1);
+    int cell = z * p->cols + x;
+    if(pos.y > p->cellTop[cell] + PVS_TOP_SLACK){return -1;}
+    return cell;
+}
+
+bool IsPvsCellVisible(const Pvs *p, int from, int to)
+{
+    if(from < 0 || to < 0){return true;}
+    return (p->bits[from * p->rowBytes + (to >> 3)] >> (to & 7)) & 1;
+}
+
+//true when any cell the box covers, or one next to it, might be seen from the from cell
+//the extra ring is for walls sitting in cells nobody stands in, their faces are seen from the floor cells beside them
+bool IsBoxInPvs(const Pvs *p, int from, BoundingBox box)
+{
+    if(from < 0 || p->cellCount == 0){return true;}
+    int x0 = ClampInt((int)floorf((box.min.x - p->minX) / p->cellSize) - 1, 0, p->cols - 1);
+    int x1 = ClampInt((int)floorf((box.max.x - p->minX) / p->cellSize) + 1, 0, p->cols - 1);
+    int z0 = ClampInt((int)floorf((box.min.z - p->minZ) / p->cellSize) - 1, 0, p->rows - 1);
+    int z1 = ClampInt((int)floorf((box.max.z - p->minZ) / p->cellSize) + 1, 0, p->rows - 1);
+    for(int z = z0; z <= z1; z++)
+    {
+        for(int x = x0; x <= x1; x++)
+        {
+            if(IsPvsCellVisible(p, from, z * p->cols + x)){return true;}
+        }
+    }
+    return false;
+}
+
+void UnloadPvs(Pvs *p)
+{
+    if(p->bits){MemFree(p->bits);}
+    if(p->cellTop){MemFree(p->cellTop);}
+    *p = (Pvs){0};
+}
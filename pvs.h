@@ -0,0 +1,44 @@
+#ifndef PVS_H
+#define PVS_H
+
+#include "raylib.h"
+#include "raycast.h"
+#include "ground_field.h"
+
+//constants
+#define PVS_CELL_SIZE 8.0f //meters, same as the world grid
+#define PVS_MAX_CELLS 4096 //cell size grows past this, the visibility table is cells * cells bits
+#define PVS_MAX_DIST 120.0f //cells further apart than this are left visible, distance culling handles them
+#define PVS_SAMPLE_COLUMNS 3 //3x3 sample columns per cell
+#define PVS_MAX_SAMPLES 96 //eye points per cell, a cell with more is left seeing everything
+#define PVS_EYE_CROUCH 0.45f //sample heights above a floor, the mc crouching
+#define PVS_EYE_STAND 1.8f //standing
+#define PVS_EYE_JUMP 2.9f //and standing at the top of a jump
+#define PVS_LAYER_GAP 2.0f //floors closer than this are one layer
+#define PVS_CLIMB_HEIGHT 1.5f //a jump plus a step, other tops count as floors when a floor this close below is around
+#define PVS_CLIMB_REACH 2.0f //meters around the sample column searched for that floor
+#define PVS_TOP_SLACK 0.5f //positions this far above the highest sample of their cell are off the pvs
+
+//structs
+//x/z cells with a bit per cell pair, bit (a, b) set when anything in b might be seen from a
+//rows start on a byte so the build can fill them on separate threads
+typedef struct {
+    float minX;
+    float minZ;
+    float cellSize;
+    int cols;
+    int rows;
+    int cellCount;
+    int rowBytes;
+    unsigned char *bits;
+    float *cellTop; //highest sample per cell, INFINITY when the cell sees everything anyway
+} Pvs;
+
+//functions
+Pvs BuildPvs(RaycastScene *scene, GroundField *ground, const bool *floorObj, BoundingBox bounds);
+int GetPvsCell(const Pvs *p, Vector3 pos);
+bool IsPvsCellVisible(const Pvs *p, int from, int to);
+bool IsBoxInPvs(const Pvs *p, int from, BoundingBox box);
+void UnloadPvs(Pvs *p);
+
+#endif // PVS_H
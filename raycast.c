@@ -0,0 +1,305 @@
+#include "raycast.h"
+#include "raylib.h"
+#include "raymath.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#if defined(COLLISION_SIMD_SSE2)
+    #include <emmintrin.h>
+#elif defined(COLLISION_SIMD_NEON)
+    #include <arm_neon.h>
+#endif
+
+RaycastScene BuildRaycastScene(const RayPrim *prims, int count)
+{
+    RaycastScene s = {0};
+    if(count <= 0){return s;}
+
+    s.primCount = count;
+    s.prims = MemAlloc(sizeof(RayPrim) * count);
+    memcpy(s.prims, prims, sizeof(RayPrim) * count);
+    BoundingBox *boxes = MemAlloc(sizeof(BoundingBox) * count);
+    for(int i = 0; i < count; i++){boxes[i] = prims[i].box;}
+    s.bvh = BuildBvh(boxes, count);
+    MemFree(boxes);
+    printf("raycast scene: %d prims, %d bvh nodes\n", s.primCount, s.bvh.nodeCount);
+    return s;
+}
+
+//from now on every query also counts its prim tests per env object, in objTests
+void TrackRaycastObjects(RaycastScene *s, int objCount)
+{
+    if(objCount <= 0){return;}
+    s->objTests = MemAlloc(sizeof(int) * objCount);
+    s->touched = MemAlloc(sizeof(int) * objCount);
+    s->touchedCount = 0;
+}
+
+//clears what the last query counted
+static void BeginRaycastQuery(RaycastScene *s)
+{
+    s->lastTests = 0;
+    for(int i = 0; i < s->touchedCount; i++){s->objTests[s->touched[i]] = 0;}
+    s->touchedCount = 0;
+}
+
+static void CountObjectTests(RaycastScene *s, int obj, int n)
+{
+    s->lastTests += n;
+    if(!s->objTests){return;}
+    if(s->objTests[obj] == 0){s->touched[s->touchedCount++] = obj;}
+    s->objTests[obj] += n;
+}
+
+//slab test, entry distance goes negative when the ray starts inside the box like GetRayCollisionBox
+static bool RayBoxEntry(Vector3 origin, Vector3 invDir, BoundingBox box, float *tEnter)
+{
+    float t0 = (box.min.x - origin.x) * invDir.x;
+    float t1 = (box.max.x - origin.x) * invDir.x;
+    float tMin = fminf(t0, t1);
+    float tMax = fmaxf(t0, t1);
+    t0 = (box.min.y - origin.y) * invDir.y;
+    t1 = (box.max.y - origin.y) * invDir.y;
+    tMin = fmaxf(tMin, fminf(t0, t1));
+    tMax = fminf(tMax, fmaxf(t0, t1));
+    t0 = (box.min.z - origin.z) * invDir.z;
+    t1 = (box.max.z - origin.z) * invDir.z;
+    tMin = fmaxf(tMin, fminf(t0, t1));
+    tMax = fminf(tMax, fmaxf(t0, t1));
+    *tEnter = tMin;
+    return tMax >= 0.0f && tMin <= tMax;
+}
+
+//the hit distance on one prim, brushes refine their box hit with the planes
+static bool RayPrimHit(RaycastScene *s, const RayPrim *p, Ray ray, Vector3 invDir, float *dist)
+{
+    CountObjectTests(s, p->obj, 1);
+    if(!RayBoxEntry(ray.position, invDir, p->box, dist)){return false;}
+    if(p->planeCount > 0)
+    {
+        CountObjectTests(s, p->obj, 1);
+        RayCollision coll = GetRayCollisionBrush(ray, p->planes, p->planeCount);
+        if(!coll.hit){return false;}
+        *dist = coll.distance;
+    }
+    return true;
+}
+
+//walks the bvh, any hit closer than maxDist ends the walk early when anyHit is set
+static RayHit Raycast(RaycastScene *s, Ray ray, float maxDist, bool anyHit)
+{
+    RayHit best = { false, maxDist, -1, -1 };
+    BeginRaycastQuery(s);
+    if(s->bvh.nodeCount == 0){return best;}
+
+    Vector3 invDir = { 1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z };
+    //nodes are box tested before they are pushed, the stack keeps their entry distance for pruning
+    int stack[BVH_STACK_SIZE];
+    float stackT[BVH_STACK_SIZE];
+    int top = 0;
+    float tRoot;
+    s->lastTests++;
+    if(!RayBoxEntry(ray.position, invDir, s->bvh.nodes[0].box, &tRoot)){return best;}
+    stack[top] = 0;
+    stackT[top++] = tRoot;
+    while(top > 0)
+    {
+        top--;
+        if(stackT[top] >= best.distance){continue;}
+        const BvhNode *node = &s->bvh.nodes[stack[top]];
+        if(node->left < 0)
+        {
+            for(int i = 0; i < node->count; i++)
+            {
+                int p = s->bvh.prims[node->first + i];
+                float d;
+                if(!RayPrimHit(s, &s->prims[p], ray, invDir, &d) || d >= best.distance){continue;}
+                best = (RayHit){ true, d, s->prims[p].obj, s->prims[p].hitBox };
+                if(anyHit){return best;}
+            }
+            continue;
+        }
+        float tLeft, tRight;
+        bool hitLeft = RayBoxEntry(ray.position, invDir, s->bvh.nodes[node->left].box, &tLeft);
+        bool hitRight = RayBoxEntry(ray.position, invDir, s->bvh.nodes[node->right].box, &tRight);
+        s->lastTests += 2;
+        //push the far child first so the near one is walked first and shrinks best.distance sooner
+        if(hitLeft && hitRight && tLeft > tRight)
+        {
+            stack[top] = node->left; stackT[top++] = tLeft;
+            stack[top] = node->right; stackT[top++] = tRight;
+        }
+        else
+        {
+            if(hitRight){stack[top] = node->right; stackT[top++] = tRight;}
+            if(hitLeft){stack[top] = node->left; stackT[top++] = tLeft;}
+        }
+    }
+    return best;
+}
+
+//closest static hit in front of the ray, only hits nearer than maxDist count
+RayHit RaycastClosest(RaycastScene *s, Ray ray, float maxDist)
+{
+    return Raycast(s, ray, maxDist, false);
+}
+
+//shadow ray, true as soon as anything nearer than maxDist is hit
+bool RaycastAny(RaycastScene *s, Ray ray, float maxDist)
+{
+    return Raycast(s, ray, maxDist, true).hit;
+}
+
+RayPacket MakeRayPacket(const Ray *rays, int count, float maxDist)
+{
+    RayPacket p = {0};
+    if(count > RAY_PACKET_MAX){count = RAY_PACKET_MAX;}
+    p.count = count;
+    p.laneMask = (1 << count) - 1;
+    for(int i = 0; i < count; i++)
+    {
+        p.rays[i] = rays[i];
+        p.ox[i] = rays[i].position.x; p.oy[i] = rays[i].position.y; p.oz[i] = rays[i].position.z;
+        p.ix[i] = 1.0f / rays[i].direction.x; p.iy[i] = 1.0f / rays[i].direction.y; p.iz[i] = 1.0f / rays[i].direction.z;
+        p.tMax[i] = maxDist;
+    }
+    return p;
+}
+
+//slab test of RAY_PACKET_LANES rays starting at lane first against one box, bit per lane that enters it before its tMax
+static int RayPacketBoxLanes(const RayPacket *p, int first, BoundingBox box, float *tEnter)
+{
+#if defined(COLLISION_SIMD_SSE2)
+    __m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box.min.x), _mm_loadu_ps(&p->ox[first])), _mm_loadu_ps(&p->ix[first]));
+    __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box.max.x), _mm_loadu_ps(&p->ox[first])), _mm_loadu_ps(&p->ix[first]));
+    __m128 tMin = _mm_min_ps(t0, t1);
+    __m128 tMax = _mm_max_ps(t0, t1);
+    t0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box.min.y), _mm_loadu_ps(&p->oy[first])), _mm_loadu_ps(&p->iy[first]));
+    t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box.max.y), _mm_loadu_ps(&p->oy[first])), _mm_loadu_ps(&p->iy[first]));
+    tMin = _mm_max_ps(tMin, _mm_min_ps(t0, t1));
+    tMax = _mm_min_ps(tMax, _mm_max_ps(t0, t1));
+    t0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box.min.z), _mm_loadu_ps(&p->oz[first])), _mm_loadu_ps(&p->iz[first]));
+    t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box.max.z), _mm_loadu_ps(&p->oz[first])), _mm_loadu_ps(&p->iz[first]));
+    tMin = _mm_max_ps(tMin, _mm_min_ps(t0, t1));
+    tMax = _mm_min_ps(tMax, _mm_max_ps(t0, t1));
+    _mm_storeu_ps(&tEnter[first], tMin);
+    __m128 hit = _mm_and_ps(_mm_cmpge_ps(tMax, _mm_setzero_ps()), _mm_cmple_ps(tMin, tMax));
+    hit = _mm_and_ps(hit, _mm_cmplt_ps(tMin, _mm_loadu_ps(&p->tMax[first])));
+    return _mm_movemask_ps(hit);
+#elif defined(COLLISION_SIMD_NEON)
+    float32x4_t t0 = vmulq_f32(vsubq_f32(vdupq_n_f32(box.min.x), vld1q_f32(&p->ox[first])), vld1q_f32(&p->ix[first]));
+    float32x4_t t1 = vmulq_f32(vsubq_f32(vdupq_n_f32(box.max.x), vld1q_f32(&p->ox[first])), vld1q_f32(&p->ix[first]));
+    float32x4_t tMin = vminq_f32(t0, t1);
+    float32x4_t tMax = vmaxq_f32(t0, t1);
+    t0 = vmulq_f32(vsubq_f32(vdupq_n_f32(box.min.y), vld1q_f32(&p->oy[first])), vld1q_f32(&p->iy[first]));
+    t1 = vmulq_f32(vsubq_f32(vdupq_n_f32(box.max.y), vld1q_f32(&p->oy[first])), vld1q_f32(&p->iy[first]));
+    tMin = vmaxq_f32(tMin, vminq_f32(t0, t1));
+    tMax = vminq_f32(tMax, vmaxq_f32(t0, t1));
+    t0 = vmulq_f32(vsubq_f32(vdupq_n_f32(box.min.z), vld1q_f32(&p->oz[first])), vld1q_f32(&p->iz[first]));
+    t1 = vmulq_f32(vsubq_f32(vdupq_n_f32(box.max.z), vld1q_f32(&p->oz[first])), vld1q_f32(&p->iz[first]));
+    tMin = vmaxq_f32(tMin, vminq_f32(t0, t1));
+    tMax = vminq_f32(tMax, vmaxq_f32(t0, t1));
+    vst1q_f32(&tEnter[first], tMin);
+    uint32x4_t hit = vandq_u32(vcgeq_f32(tMax, vdupq_n_f32(0.0f)), vcleq_f32(tMin, tMax));
+    hit = vandq_u32(hit, vcltq_f32(tMin, vld1q_f32(&p->tMax[first])));
+    uint32_t lanes[4];
+    vst1q_u32(lanes, hit);
+    return (lanes[0] & 1) | (lanes[1] & 2) | (lanes[2] & 4) | (lanes[3] & 8);
+#else
+    int mask = 0;
+    for(int i = first; i < first + RAY_PACKET_LANES; i++)
+    {
+        Vector3 origin = { p->ox[i], p->oy[i], p->oz[i] };
+        Vector3 invDir = { p->ix[i], p->iy[i], p->iz[i] };
+        if(RayBoxEntry(origin, invDir, box, &tEnter[i]) && tEnter[i] < p->tMax[i]){mask |= 1 << (i - first);}
+    }
+    return mask;
+#endif
+}
+
+//every ray of laneMask that enters box before its tMax, as a bit mask, entry distances go to tEnter (RAY_PACKET_MAX floats)
+//lane groups with no ray left in laneMask are skipped
+int RayPacketBoxMask(const RayPacket *p, int laneMask, BoundingBox box, float *tEnter)
+{
+    int mask = 0;
+    for(int first = 0; first < p->count; first += RAY_PACKET_LANES)
+    {
+        int groupMask = (laneMask >> first) & ((1 << RAY_PACKET_LANES) - 1);
+        if(groupMask == 0){continue;}
+        mask |= (RayPacketBoxLanes(p, first, box, tEnter) & groupMask) << first;
+    }
+    return mask;
+}
+
+static int CountLaneGroups(int laneMask)
+{
+    int groups = 0;
+    for(int first = 0; first < RAY_PACKET_MAX; first += RAY_PACKET_LANES)
+    {
+        if((laneMask >> first) & ((1 << RAY_PACKET_LANES) - 1)){groups++;}
+    }
+    return groups;
+}
+
+//closest static hit for every ray of laneMask, the whole packet walks the bvh once and a node is
+//entered while any ray still reaches it, out gets one RayHit per ray and p->tMax shrinks to the hits
+void RaycastPacketClosest(RaycastScene *s, RayPacket *p, int laneMask, RayHit *out)
+{
+    for(int i = 0; i < p->count; i++){out[i] = (RayHit){ false, p->tMax[i], -1, -1 };}
+    BeginRaycastQuery(s);
+    laneMask &= p->laneMask;
+    if(s->bvh.nodeCount == 0 || laneMask == 0){return;}
+
+    float tEnter[RAY_PACKET_MAX];
+    int stack[BVH_STACK_SIZE];
+    int stackMask[BVH_STACK_SIZE];
+    int top = 0;
+    stack[top] = 0;
+    stackMask[top++] = laneMask;
+    while(top > 0)
+    {
+        top--;
+        const BvhNode *node = &s->bvh.nodes[stack[top]];
+        //tMax may have shrunk since the node was pushed, so the mask is worked out on the way in
+        s->lastTests += CountLaneGroups(stackMask[top]);
+        int mask = RayPacketBoxMask(p, stackMask[top], node->box, tEnter);
+        if(mask == 0){continue;}
+        if(node->left >= 0)
+        {
+            stack[top] = node->right; stackMask[top++] = mask;
+            stack[top] = node->left; stackMask[top++] = mask;
+            continue;
+        }
+        for(int i = 0; i < node->count; i++)
+        {
+            int prim = s->bvh.prims[node->first + i];
+            const RayPrim *rp = &s->prims[prim];
+            CountObjectTests(s, rp->obj, CountLaneGroups(mask));
+            int primMask = RayPacketBoxMask(p, mask, rp->box, tEnter);
+            for(int r = 0; r < p->count; r++)
+            {
+                if(!(primMask & (1 << r))){continue;}
+                float d = tEnter[r];
+                if(rp->planeCount > 0)
+                {
+                    CountObjectTests(s, rp->obj, 1);
+                    RayCollision coll = GetRayCollisionBrush(p->rays[r], rp->planes, rp->planeCount);
+                    if(!coll.hit || coll.distance >= p->tMax[r]){continue;}
+                    d = coll.distance;
+                }
+                out[r] = (RayHit){ true, d, rp->obj, rp->hitBox };
+                p->tMax[r] = d;
+            }
+        }
+    }
+}
+
+void UnloadRaycastScene(RaycastScene *s)
+{
+    UnloadBvh(&s->bvh);
+    if(s->prims){MemFree(s->prims);}
+    if(s->objTests){MemFree(s->objTests);}
+    if(s->touched){MemFree(s->touched);}
+    *s = (RaycastScene){0};
+}
@@ -0,0 +1,63 @@
+#ifndef RAYCAST_H
+#define RAYCAST_H
+
+#include "raylib.h"
+#include "bvh.h"
+#include "brush.h"
+#include "collision_mesh.h" //COLLISION_SIMD_* picks the packet slab kernel too
+
+//constants
+#define RAY_PACKET_MAX 16 //rays per packet, a multiple of 4 so every lane group is full width
+#define RAY_PACKET_LANES 4 //rays per slab kernel step
+
+//structs
+//one static thing a ray can hit, an env object box or one of its hit boxes
+typedef struct {
+    BoundingBox box;
+    int obj; //env object index
+    int hitBox; //hit box index, -1 for the object box
+    int planeCount; //brush planes for an exact hit inside the box, 0 to stop at the box
+    const BrushPlane *planes;
+} RayPrim;
+
+typedef struct {
+    bool hit;
+    float distance;
+    int obj;
+    int hitBox;
+} RayHit;
+
+//every static ray blocker of a level under one bvh
+typedef struct {
+    Bvh bvh;
+    RayPrim *prims;
+    int primCount;
+    int lastTests; //box and brush tests done by the last query, for collision stats
+    //prim tests of the last query per env object, NULL until TrackRaycastObjects, not for queries on several threads
+    int *objTests;
+    int *touched; //objects with a nonzero objTests entry
+    int touchedCount;
+} RaycastScene;
+
+//structure of arrays bundle of rays sharing an origin area, like shotgun pellets, walked through the bvh together
+//padding lanes past count have tMax 0 so they never hit
+typedef struct {
+    float ox[RAY_PACKET_MAX], oy[RAY_PACKET_MAX], oz[RAY_PACKET_MAX];
+    float ix[RAY_PACKET_MAX], iy[RAY_PACKET_MAX], iz[RAY_PACKET_MAX]; //1 / direction
+    float tMax[RAY_PACKET_MAX]; //hits at or past this do not count, the closest query shrinks it
+    Ray rays[RAY_PACKET_MAX];
+    int count;
+    int laneMask; //bit per real ray
+} RayPacket;
+
+//functions
+RaycastScene BuildRaycastScene(const RayPrim *prims, int count);
+void TrackRaycastObjects(RaycastScene *s, int objCount);
+RayHit RaycastClosest(RaycastScene *s, Ray ray, float maxDist);
+bool RaycastAny(RaycastScene *s, Ray ray, float maxDist);
+RayPacket MakeRayPacket(const Ray *rays, int count, float maxDist);
+int RayPacketBoxMask(const RayPacket *p, int laneMask, BoundingBox box, float *tEnter);
+void RaycastPacketClosest(RaycastScene *s, RayPacket *p, int laneMask, RayHit *out);
+void UnloadRaycastScene(RaycastScene *s);
+
+#endif // RAYCAST_H
@@ -0,0 +1,96 @@
+#include "render_queue.h"
+#include "raylib.h"
+#include "raymath.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//diffuse texture of the first mesh, what the sort groups by
+static unsigned int ModelTextureId(Model model)
+{
+    if(model.meshCount <= 0 || model.materialCount <= 0 || model.materials == NULL){return 0;}
+    int material = model.meshMaterial ? model.meshMaterial[0] : 0;
+    return model.materials[material].maps[MATERIAL_MAP_DIFFUSE].texture.id;
+}
+
+static unsigned int QuantizeDepth(float depth)
+{
+    float t = depth / RENDER_QUEUE_FAR;
+    if(t < 0.0f){t = 0.0f;}
+    if(t > 1.0f){t = 1.0f;}
+    return (unsigned int)(t * RENDER_DEPTH_MASK);
+}
+
+static int CompareRenderEntries(const void *a, const void *b)
+{
+    const RenderSortEntry *ea = a;
+    const RenderSortEntry *eb = b;
+    if(ea->key != eb->key){return ea->key < eb->key ? -1 : 1;}
+    return ea->item - eb->item; //submission order breaks ties so the frame does not flicker
+}
+
+void BeginRenderQueue(RenderQueue *q)
+{
+    q->count = 0;
+}
+
+//key, high to low: pass (2 bits), then texture and depth for opaque, or far to near depth then texture for fading
+void SubmitRenderItem(RenderQueue *q, RenderPass pass, Model model, Vector3 pos, float yaw, Color tint, float depth)
+{
+    if(q->count == q->capacity)
+    {
+        q->capacity = q->capacity > 0 ? q->capacity * 2 : 256;
+        q->items = MemRealloc(q->items, sizeof(RenderItem) * q->capacity);
+        q->order = MemRealloc(q->order, sizeof(RenderSortEntry) * q->capacity);
+    }
+    unsigned long long texture = ModelTextureId(model) & RENDER_TEXTURE_MASK;
+    unsigned long long z = QuantizeDepth(depth);
+    unsigned long long key = (unsigned long long)pass << 62;
+    if(pass == RENDER_PASS_OPAQUE){key |= (texture << 24) | z;}
+    else{key |= ((RENDER_DEPTH_MASK - z) << 24) | texture;}
+    q->items[q->count] = (RenderItem){ model, pos, yaw, tint };
+    q->order[q->count] = (RenderSortEntry){ key, q->count };
+    q->count++;
+}
+
+void SortRenderQueue(RenderQueue *q)
+{
+    qsort(q->order, q->count, sizeof(RenderSortEntry), CompareRenderEntries);
+}
+
+//walks the sorted items of one pass, the pass is the top of the key so they are one contiguous run
+static int WalkRenderQueuePass(RenderQueue *q, RenderPass pass, bool draw)
+{
+    int draws = 0;
+    unsigned int lastTexture = 0;
+    for(int i = 0; i < q->count; i++)
+    {
+        if((int)(q->order[i].key >> 62) != (int)pass){continue;}
+        const RenderItem *item = &q->items[q->order[i].item];
+        unsigned int texture = ModelTextureId(item->model);
+        if(texture != lastTexture){q->textureSwitches++; lastTexture = texture;}
+        if(draw){DrawModelEx(item->model, item->pos, (Vector3){0, 1, 0}, item->yaw, (Vector3){1, 1, 1}, item->tint);}
+        draws++;
+    }
+    q->draws += draws;
+    return draws;
+}
+
+void DrawRenderQueuePass(RenderQueue *q, RenderPass pass)
+{
+    WalkRenderQueuePass(q, pass, true);
+}
+
+//null renderer side, the same stats as DrawRenderQueuePass without drawing, returns the draw calls of the pass
+int CountRenderQueuePass(RenderQueue *q, RenderPass pass)
+{
+    return WalkRenderQueuePass(q, pass, false);
+}
+
+void UnloadRenderQueue(RenderQueue *q)
+{
+    printf("render queue: %ld draws, %ld texture switches\n", q->draws, q->textureSwitches);
+    if(q->items){MemFree(q->items);}
+    if(q->order){MemFree(q->order);}
+    memset(q, 0, sizeof(RenderQueue));
+}
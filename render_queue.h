@@ -0,0 +1,50 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include "raylib.h"
+
+//constants
+#define RENDER_QUEUE_FAR 200.0f //meters, depth is quantized over 0 .. this, the furthest anything is drawn
+#define RENDER_DEPTH_MASK 0xffffffu //24 bits of depth in the key
+#define RENDER_TEXTURE_MASK 0xffffffu //24 bits of texture id in the key
+
+//enums
+typedef enum {
+    RENDER_PASS_OPAQUE = 0, //grouped by texture, front to back inside a texture so early z rejects what is behind
+    RENDER_PASS_FADING = 1 //see through, back to front after everything opaque
+} RenderPass;
+
+//structs
+//one queued DrawModelEx
+typedef struct {
+    Model model; //copy, meshes may be swapped for a skinned frame
+    Vector3 pos;
+    float yaw; //degrees around y
+    Color tint;
+} RenderItem;
+
+//key and item index, sorted instead of the items themselves
+typedef struct {
+    unsigned long long key;
+    int item;
+} RenderSortEntry;
+
+//draws of one frame, the arrays grow and never shrink so steady frames do not allocate
+typedef struct {
+    RenderItem *items;
+    RenderSortEntry *order;
+    int count;
+    int capacity;
+    long draws;
+    long textureSwitches;
+} RenderQueue;
+
+//functions
+void BeginRenderQueue(RenderQueue *q);
+void SubmitRenderItem(RenderQueue *q, RenderPass pass, Model model, Vector3 pos, float yaw, Color tint, float depth);
+void SortRenderQueue(RenderQueue *q);
+void DrawRenderQueuePass(RenderQueue *q, RenderPass pass);
+int CountRenderQueuePass(RenderQueue *q, RenderPass pass);
+void UnloadRenderQueue(RenderQueue *q);
+
+#endif // RENDER_QUEUE_H
@@ -0,0 +1,401 @@
+#include "skin_cache.h"
+#include "job_pool.h"
+#include "arena.h"
+#include "raylib.h"
+#include "raymath.h"
+#include "rlgl.h"
+#include <stdio.h>
+#include <string.h>
+
+#if defined(COLLISION_SIMD_SSE2)
+    #include <emmintrin.h>
+#elif defined(COLLISION_SIMD_NEON)
+    #include <arm_neon.h>
+#endif
+
+#define SKIN_MESH_VERTEX_BUFFERS 7 //raylib vbo slots, 0 positions and 2 normals are the ones skinning touches
+
+//one slice of one mesh of one queued frame, the unit the job pool hands out
+typedef struct {
+    const SkinCache *cache;
+    const float *boneMats;
+    const Mesh *src;
+    Mesh *dst;
+    int first;
+    int last;
+} SkinJob;
+
+//frames queued by RequestSkinnedMeshes, skinned together in RunSkinJobs
+static SkinCache *pendingCache[SKIN_CACHE_MAX_PENDING];
+static SkinCacheEntry *pendingEntry[SKIN_CACHE_MAX_PENDING];
+static int pendingCount = 0;
+//counts RunSkinJobs calls, one per update, entries handed to this frame's draw are not reused until the next one
+static unsigned int skinFrame = 1;
+
+//the UpdateModelAnimation transform of every bone as matrix columns, sub > 0 blends toward the next keyframe first
+//position: rotate(frame rot * inverse bind rot) after scale, bind translation folded into the last column
+//normal: the rotation alone, like UpdateModelAnimation
+static void ComputeBoneMatrices(const SkinCache *c, int anim, int frame, int sub, float *mats)
+{
+    const ModelAnimation *a = &c->anims[anim];
+    const Transform *pose = a->framePoses[frame];
+    const Transform *next = a->framePoses[sub > 0 ? frame + 1 : frame];
+    float t = sub / (float)SKIN_CACHE_SUBFRAMES;
+    for(int b = 0; b < c->model.boneCount; b++)
+    {
+        float *m = &mats[b * SKIN_BONE_FLOATS];
+        memset(m, 0, sizeof(float) * SKIN_BONE_FLOATS);
+        if(b >= a->boneCount){continue;}//no pose for this bone, its weights count for nothing
+        Transform bone = pose[b];
+        if(sub > 0)
+        {
+            bone.translation = Vector3Lerp(pose[b].translation, next[b].translation, t);
+            bone.rotation = QuaternionNlerp(pose[b].rotation, next[b].rotation, t); //neighbour keyframes, nlerp is close enough
+            bone.scale = Vector3Lerp(pose[b].scale, next[b].scale, t);
+        }
+        Quaternion rot = QuaternionMultiply(bone.rotation, QuaternionInvert(c->model.bindPose[b].rotation));
+        Vector3 col[3] = {
+            Vector3RotateByQuaternion((Vector3){1, 0, 0}, rot),
+            Vector3RotateByQuaternion((Vector3){0, 1, 0}, rot),
+            Vector3RotateByQuaternion((Vector3){0, 0, 1}, rot)
+        };
+        const float *scale = &bone.scale.x;
+        const float *bind = &c->model.bindPose[b].translation.x;
+        Vector3 offset = bone.translation;
+        for(int k = 0; k < 3; k++)
+        {
+            Vector3 p = Vector3Scale(col[k], scale[k]);
+            m[k * 4 + 0] = p.x; m[k * 4 + 1] = p.y; m[k * 4 + 2] = p.z;
+            offset = Vector3Subtract(offset, Vector3Scale(p, bind[k]));
+            m[16 + k * 4 + 0] = col[k].x; m[16 + k * 4 + 1] = col[k].y; m[16 + k * 4 + 2] = col[k].z;
+        }
+        m[12] = offset.x; m[13] = offset.y; m[14] = offset.z;
+    }
+}
+
+//skins vertices first .. last-1 of src into dst, the four weighted bone matrices are blended first and applied once
+static void SkinVertices(const SkinCache *c, const float *mats, const Mesh *src, Mesh *dst, int first, int last)
+{
+    const int boneCount = c->model.boneCount;
+    for(int v = first; v < last; v++)
+    {
+        const float *pos = &src->vertices[v * 3];
+        const float *nrm = src->normals ? &src->normals[v * 3] : NULL;
+        float outPos[4];
+        float outNrm[4];
+#if defined(COLLISION_SIMD_SSE2)
+        __m128 c0 = _mm_setzero_ps(), c1 = c0, c2 = c0, c3 = c0, n0 = c0, n1 = c0, n2 = c0;
+        for(int j = 0; j < 4; j++)
+        {
+            float w = src->boneWeights[v * 4 + j];
+            int b = src->boneIds[v * 4 + j];
+            if(w <= 0.0f || b >= boneCount){continue;}
+            const float *m = &mats[b * SKIN_BONE_FLOATS];
+            __m128 wv = _mm_set1_ps(w);
+            c0 = _mm_add_ps(c0, _mm_mul_ps(wv, _mm_loadu_ps(m)));
+            c1 = _mm_add_ps(c1, _mm_mul_ps(wv, _mm_loadu_ps(m + 4)));
+            c2 = _mm_add_ps(c2, _mm_mul_ps(wv, _mm_loadu_ps(m + 8)));
+            c3 = _mm_add_ps(c3, _mm_mul_ps(wv, _mm_loadu_ps(m + 12)));
+            n0 = _mm_add_ps(n0, _mm_mul_ps(wv, _mm_loadu_ps(m + 16)));
+            n1 = _mm_add_ps(n1, _mm_mul_ps(wv, _mm_loadu_ps(m + 20)));
+            n2 = _mm_add_ps(n2, _mm_mul_ps(wv, _mm_loadu_ps(m + 24)));
+        }
+        __m128 p = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(pos[0])), _mm_mul_ps(c1, _mm_set1_ps(pos[1]))),
+                              _mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(pos[2])), c3));
+        _mm_storeu_ps(outPos, p);
+        if(nrm)
+        {
+            __m128 n = _mm_add_ps(_mm_add_ps(_mm_mul_ps(n0, _mm_set1_ps(nrm[0])), _mm_mul_ps(n1, _mm_set1_ps(nrm[1]))), _mm_mul_ps(n2, _mm_set1_ps(nrm[2])));
+            _mm_storeu_ps(outNrm, n);
+        }
+#elif defined(COLLISION_SIMD_NEON)
+        float32x4_t c0 = vdupq_n_f32(0.0f), c1 = c0, c2 = c0, c3 = c0, n0 = c0, n1 = c0, n2 = c0;
+        for(int j = 0; j < 4; j++)
+        {
+            float w = src->boneWeights[v * 4 + j];
+            int b = src->boneIds[v * 4 + j];
+            if(w <= 0.0f || b >= boneCount){continue;}
+            const float *m = &mats[b * SKIN_BONE_FLOATS];
+            c0 = vmlaq_n_f32(c0, vld1q_f32(m), w);
+            c1 = vmlaq_n_f32(c1, vld1q_f32(m + 4), w);
+            c2 = vmlaq_n_f32(c2, vld1q_f32(m + 8), w);
+            c3 = vmlaq_n_f32(c3, vld1q_f32(m + 12), w);
+            n0 = vmlaq_n_f32(n0, vld1q_f32(m + 16), w);
+            n1 = vmlaq_n_f32(n1, vld1q_f32(m + 20), w);
+            n2 = vmlaq_n_f32(n2, vld1q_f32(m + 24), w);
+        }
+        float32x4_t p = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(c3, c0, pos[0]), c1, pos[1]), c2, pos[2]);
+        vst1q_f32(outPos, p);
+        if(nrm)
+        {
+            float32x4_t n = vmlaq_n_f32(vmlaq_n_f32(vmulq_n_f32(n0, nrm[0]), n1, nrm[1]), n2, nrm[2]);
+            vst1q_f32(outNrm, n);
+        }
+#else
+        float blend[SKIN_BONE_FLOATS] = {0};
+        for(int j = 0; j < 4; j++)
+        {
+            float w = src->boneWeights[v * 4 + j];
+            int b = src->boneIds[v * 4 + j];
+            if(w <= 0.0f || b >= boneCount){continue;}
+            const float *m = &mats[b * SKIN_BONE_FLOATS];
+            for(int k = 0; k < SKIN_BONE_FLOATS; k++){blend[k] += w * m[k];}
+        }
+        for(int k = 0; k < 3; k++)
+        {
+            outPos[k] = blend[k] * pos[0] + blend[4 + k] * pos[1] + blend[8 + k] * pos[2] + blend[12 + k];
+            if(nrm){outNrm[k] = blend[16 + k] * nrm[0] + blend[20 + k] * nrm[1] + blend[24 + k] * nrm[2];}
+        }
+#endif
+        memcpy(&dst->vertices[v * 3], outPos, sizeof(float) * 3);
+        if(nrm && dst->normals){memcpy(&dst->normals[v * 3], outNrm, sizeof(float) * 3);}
+    }
+}
+
+static void SkinMeshes(const SkinCache *c, const float *mats, Mesh *out)
+{
+    for(int m = 0; m < c->model.meshCount; m++)
+    {
+        const Mesh *src = &c->model.meshes[m];
+        if(src->boneIds == NULL || src->boneWeights == NULL){continue;}
+        SkinVertices(c, mats, src, &out[m], 0, src->vertexCount);
+    }
+}
+
+static void RunSkinJob(void *ctx, int index)
+{
+    const SkinJob *job = &((const SkinJob *)ctx)[index];
+    SkinVertices(job->cache, job->boneMats, job->src, job->dst, job->first, job->last);
+}
+
+//gpu side of an entry is made on first use, the entry keeps its buffers and only re-uploads them when it is reused
+static void CreateEntryMeshes(SkinCache *c, SkinCacheEntry *e)
+{
+    e->meshes = MemAlloc(sizeof(Mesh) * c->model.meshCount);
+    for(int m = 0; m < c->model.meshCount; m++)
+    {
+        const Mesh *src = &c->model.meshes[m];
+        Mesh dst = *src; //texcoords, indices and the rest stay shared with the model
+        dst.vertices = MemAlloc(sizeof(float) * src->vertexCount * 3);
+        memcpy(dst.vertices, src->vertices, sizeof(float) * src->vertexCount * 3);
+        dst.normals = NULL;
+        if(src->normals)
+        {
+            dst.normals = MemAlloc(sizeof(float) * src->vertexCount * 3);
+            memcpy(dst.normals, src->normals, sizeof(float) * src->vertexCount * 3);
+        }
+        dst.animVertices = NULL;
+        dst.animNormals = NULL;
+        dst.boneIds = NULL;
+        dst.boneWeights = NULL;
+        dst.vaoId = 0;
+        dst.vboId = NULL;
+        e->meshes[m] = dst;
+    }
+}
+
+//main thread only, gl calls
+static void UploadEntry(SkinCache *c, SkinCacheEntry *e)
+{
+    for(int m = 0; m < c->model.meshCount; m++)
+    {
+        Mesh *mesh = &e->meshes[m];
+        if(mesh->vboId == NULL){UploadMesh(mesh, true); continue;}
+        rlUpdateVertexBuffer(mesh->vboId[0], mesh->vertices, mesh->vertexCount * 3 * sizeof(float), 0);
+        if(mesh->normals){rlUpdateVertexBuffer(mesh->vboId[2], mesh->normals, mesh->vertexCount * 3 * sizeof(float), 0);}
+    }
+}
+
+static void ClaimEntry(SkinCache *c, SkinCacheEntry *e, int anim, int frame, int sub)
+{
+    if(e->meshes == NULL){CreateEntryMeshes(c, e);}
+    e->used = true;
+    e->anim = anim;
+    e->frame = frame;
+    e->sub = sub;
+    e->lastUse = c->tick;
+    c->skinned++;
+}
+
+//skins (anim, frame, sub) into entry e right now on this thread
+static void FillEntry(SkinCache *c, SkinCacheEntry *e, int anim, int frame, int sub)
+{
+    ClaimEntry(c, e, anim, frame, sub);
+    ComputeBoneMatrices(c, anim, frame, sub, c->boneMats);
+    SkinMeshes(c, c->boneMats, e->meshes);
+    UploadEntry(c, e);
+}
+
+//model and anims stay owned by the level, the cache only borrows them
+//short clips are baked here so walking and shooting cost nothing at run time, whole keyframes only
+void InitSkinCache(SkinCache *c, Model model, ModelAnimation *anims, int animCount)
+{
+    memset(c, 0, sizeof(SkinCache));
+    c->model = model;
+    c->anims = anims;
+    c->animCount = animCount;
+    if(model.boneCount <= 0){return;}
+    c->boneMats = MemAlloc(sizeof(float) * SKIN_BONE_FLOATS * model.boneCount);
+    int pinned = 0;
+    for(int a = 0; a < animCount; a++)
+    {
+        if(anims[a].frameCount > SKIN_CACHE_PREBAKE_FRAMES || pinned + anims[a].frameCount > SKIN_CACHE_MAX_PINNED){continue;}
+        for(int f = 0; f < anims[a].frameCount; f++)
+        {
+            SkinCacheEntry *e = &c->entries[pinned++];
+            FillEntry(c, e, a, f, 0);
+            e->pinned = true;
+        }
+    }
+    printf("skin cache: %d bones, %d animations, %d frames prebaked\n", model.boneCount, animCount, pinned);
+}
+
+//rounds the blend to the nearest sub frame, a blend that rounds up to 1 is the next keyframe
+static bool ClampSkinKey(const SkinCache *c, int anim, int *frame, float blend, int *sub)
+{
+    if(c->boneMats == NULL || anim < 0 || anim >= c->animCount || c->anims[anim].frameCount <= 0){return false;}
+    *sub = (int)(blend * SKIN_CACHE_SUBFRAMES + 0.5f);
+    if(*sub < 0){*sub = 0;}
+    if(*sub >= SKIN_CACHE_SUBFRAMES){(*frame)++; *sub = 0;}
+    if(*frame < 0){*frame = 0;}
+    if(*frame >= c->anims[anim].frameCount - 1){*frame = c->anims[anim].frameCount - 1; *sub = 0;}//nothing to blend toward
+    return true;
+}
+
+//the entry holding (anim, frame, sub), or the one to reuse for it in *victim, pinned and pending entries are never reused
+//keepDrawn also keeps the entries the draw already holds this frame, it may queue them and draw later
+static SkinCacheEntry *FindEntry(SkinCache *c, int anim, int frame, int sub, bool keepDrawn, SkinCacheEntry **victim)
+{
+    *victim = NULL;
+    for(int i = 0; i < SKIN_CACHE_MAX_ENTRIES; i++)
+    {
+        SkinCacheEntry *e = &c->entries[i];
+        if(e->used && e->anim == anim && e->frame == frame && e->sub == sub){return e;}
+        if(e->pinned || e->pending || (keepDrawn && e->drawFrame == skinFrame)){continue;}
+        if(*victim == NULL || !e->used || ((*victim)->used && e->lastUse < (*victim)->lastUse)){*victim = e;}
+    }
+    return NULL;
+}
+
+//update side, makes sure (anim, frame + blend) will be in the cache when drawn, misses are queued for RunSkinJobs
+bool RequestSkinnedMeshes(SkinCache *c, int anim, int frame, float blend)
+{
+    int sub;
+    if(!ClampSkinKey(c, anim, &frame, blend, &sub)){return false;}
+    c->tick++;
+    SkinCacheEntry *victim;
+    SkinCacheEntry *e = FindEntry(c, anim, frame, sub, false, &victim);
+    if(e){e->lastUse = c->tick; return true;}
+    if(victim == NULL){return false;}
+    float *mats = pendingCount < SKIN_CACHE_MAX_PENDING ? FrameAlloc(sizeof(float) * SKIN_BONE_FLOATS * c->model.boneCount) : NULL;
+    if(mats == NULL){FillEntry(c, victim, anim, frame, sub); return true;}//queue or arena full
+    ClaimEntry(c, victim, anim, frame, sub);
+    ComputeBoneMatrices(c, anim, frame, sub, mats);
+    victim->pending = true;
+    victim->boneMats = mats;
+    pendingCache[pendingCount] = c;
+    pendingEntry[pendingCount++] = victim;
+    return true;
+}
+
+//skins every queued frame on the job pool, sliced so one big mesh still spreads over the cores, then uploads on this thread
+static void SkinPendingEntries(void)
+{
+    if(pendingCount == 0){return;}
+    int jobCount = 0;
+    for(int p = 0; p < pendingCount; p++)
+    {
+        const SkinCache *c = pendingCache[p];
+        for(int m = 0; m < c->model.meshCount; m++)
+        {
+            if(c->model.meshes[m].boneIds == NULL || c->model.meshes[m].boneWeights == NULL){continue;}
+            jobCount += (c->model.meshes[m].vertexCount + SKIN_JOB_VERTICES - 1) / SKIN_JOB_VERTICES;
+        }
+    }
+    SkinJob *jobs = FrameAlloc(sizeof(SkinJob) * (jobCount > 0 ? jobCount : 1));
+    if(jobs == NULL)//arena full, skin them here one by one
+    {
+        for(int p = 0; p < pendingCount; p++){SkinMeshes(pendingCache[p], pendingEntry[p]->boneMats, pendingEntry[p]->meshes);}
+    }
+    else
+    {
+        int j = 0;
+        for(int p = 0; p < pendingCount; p++)
+        {
+            const SkinCache *c = pendingCache[p];
+            for(int m = 0; m < c->model.meshCount; m++)
+            {
+                const Mesh *src = &c->model.meshes[m];
+                if(src->boneIds == NULL || src->boneWeights == NULL){continue;}
+                for(int first = 0; first < src->vertexCount; first += SKIN_JOB_VERTICES)
+                {
+                    int last = first + SKIN_JOB_VERTICES < src->vertexCount ? first + SKIN_JOB_VERTICES : src->vertexCount;
+                    jobs[j++] = (SkinJob){ c, pendingEntry[p]->boneMats, src, &pendingEntry[p]->meshes[m], first, last };
+                }
+            }
+        }
+        RunJobs(RunSkinJob, jobs, jobCount);
+    }
+    for(int p = 0; p < pendingCount; p++)
+    {
+        UploadEntry(pendingCache[p], pendingEntry[p]);
+        pendingEntry[p]->pending = false;
+        pendingEntry[p]->boneMats = NULL;
+    }
+    pendingCount = 0;
+}
+
+//once per update, after the requests
+void RunSkinJobs(void)
+{
+    skinFrame++;
+    SkinPendingEntries();
+}
+
+//draw side, skinned meshes for one frame of one animation blended toward the next, skinned on the spot if nobody asked for it during the update
+//NULL when the model has no skeleton
+Mesh *GetSkinnedMeshes(SkinCache *c, int anim, int frame, float blend)
+{
+    int sub;
+    if(!ClampSkinKey(c, anim, &frame, blend, &sub)){return NULL;}
+    c->tick++;
+    SkinCacheEntry *victim;
+    SkinCacheEntry *e = FindEntry(c, anim, frame, sub, true, &victim);
+    if(e == NULL)
+    {
+        if(victim == NULL){return NULL;}
+        FillEntry(c, victim, anim, frame, sub);
+        e = victim;
+    }
+    if(e->pending){SkinPendingEntries();}//asked for this frame but nobody ran the jobs yet
+    e->lastUse = c->tick;
+    e->drawFrame = skinFrame;
+    c->draws++;
+    return e->meshes;
+}
+
+void UnloadSkinCache(SkinCache *c)
+{
+    for(int i = 0; i < SKIN_CACHE_MAX_ENTRIES; i++)
+    {
+        SkinCacheEntry *e = &c->entries[i];
+        if(e->meshes == NULL){continue;}
+        for(int m = 0; m < c->model.meshCount; m++)
+        {
+            //only what the entry owns, the shared arrays go with the model
+            Mesh *mesh = &e->meshes[m];
+            rlUnloadVertexArray(mesh->vaoId);
+            if(mesh->vboId)
+            {
+                for(int b = 0; b < SKIN_MESH_VERTEX_BUFFERS; b++){rlUnloadVertexBuffer(mesh->vboId[b]);}
+                MemFree(mesh->vboId);
+            }
+            MemFree(mesh->vertices);
+            if(mesh->normals){MemFree(mesh->normals);}
+        }
+        MemFree(e->meshes);
+    }
+    if(c->boneMats){MemFree(c->boneMats);}
+    printf("skin cache: %ld draws from %ld skinned frames\n", c->draws, c->skinned);
+    memset(c, 0, sizeof(SkinCache));
+}
@@ -0,0 +1,49 @@
+#ifndef SKIN_CACHE_H
+#define SKIN_CACHE_H
+
+#include "raylib.h"
+#include "collision_mesh.h" //COLLISION_SIMD_* picks the skinning kernel too
+
+//constants
+#define SKIN_CACHE_MAX_ENTRIES 48 //skinned frames kept per model, least recently used goes first
+#define SKIN_CACHE_PREBAKE_FRAMES 24 //clips this short are skinned for every frame at load and never dropped
+#define SKIN_CACHE_SUBFRAMES 2 //steps between two keyframes the cache blends, poses are rounded to the nearest one
+#define SKIN_CACHE_MAX_PINNED 24 //entries the prebake may take, the rest stay free for the long clips
+#define SKIN_CACHE_MAX_PENDING 32 //frames queued for the job pool per game frame, more are skinned on the spot
+#define SKIN_JOB_VERTICES 2048 //vertices per skinning job, so one big yeti still spreads over the cores
+#define SKIN_BONE_FLOATS 28 //per bone, 4 position matrix columns then 3 normal matrix columns, 4 floats each
+
+//structs
+//one (animation, frame, sub frame) of the model skinned on the cpu and uploaded once, every enemy on that frame draws it
+typedef struct {
+    bool used;
+    bool pinned; //prebaked, never evicted
+    bool pending; //queued for RunSkinJobs this frame, not evicted until it has run
+    float *boneMats; //pending only, bone matrices of the frame in the frame arena
+    int anim;
+    int frame;
+    int sub; //0 .. SKIN_CACHE_SUBFRAMES-1, blend step toward frame + 1
+    unsigned int lastUse;
+    unsigned int drawFrame; //game frame GetSkinnedMeshes last handed it out, the draw may still hold it
+    Mesh *meshes; //one per model mesh, own positions, normals and gpu buffers, the rest points at the model
+} SkinCacheEntry;
+
+typedef struct {
+    Model model; //the shared model, skinned from its bind pose
+    ModelAnimation *anims;
+    int animCount;
+    SkinCacheEntry entries[SKIN_CACHE_MAX_ENTRIES];
+    unsigned int tick;
+    float *boneMats; //bone matrix scratch for frames skinned on the spot, SKIN_BONE_FLOATS per bone
+    long draws; //GetSkinnedMeshes calls that got meshes
+    long skinned; //frames actually skinned
+} SkinCache;
+
+//functions
+void InitSkinCache(SkinCache *c, Model model, ModelAnimation *anims, int animCount);
+bool RequestSkinnedMeshes(SkinCache *c, int anim, int frame, float blend);
+void RunSkinJobs(void);
+Mesh *GetSkinnedMeshes(SkinCache *c, int anim, int frame, float blend);
+void UnloadSkinCache(SkinCache *c);
+
+#endif // SKIN_CACHE_H
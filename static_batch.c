@@ -0,0 +1,112 @@
+#include "static_batch.h"
+#include "raylib.h"
+#include "raymath.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+//one model waiting to be merged, sorted so every batch is a contiguous run
+typedef struct {
+    unsigned int textureId;
+    int cx;
+    int cz;
+    int index;
+} BatchKey;
+
+static int CompareBatchKeys(const void *a, const void *b)
+{
+    const BatchKey *ka = a;
+    const BatchKey *kb = b;
+    if(ka->textureId != kb->textureId){return ka->textureId < kb->textureId ? -1 : 1;}
+    if(ka->cx != kb->cx){return ka->cx < kb->cx ? -1 : 1;}
+    if(ka->cz != kb->cz){return ka->cz < kb->cz ? -1 : 1;}
+    return ka->index - kb->index;
+}
+
+static bool SameBatch(const BatchKey *a, const BatchKey *b)
+{
+    return a->textureId == b->textureId && a->cx == b->cx && a->cz == b->cz;
+}
+
+//merges keys[first .. first+count) into one uploaded model with the texture of the first one
+static StaticBatch MergeBatch(const Model *const *models, const BatchKey *keys, int first, int count, int vertexCount)
+{
+    StaticBatch b = {0};
+    Mesh mesh = {0};
+    mesh.vertexCount = vertexCount;
+    mesh.triangleCount = vertexCount / 3;
+    mesh.vertices = MemAlloc(sizeof(float) * vertexCount * 3);
+    mesh.normals = MemAlloc(sizeof(float) * vertexCount * 3);
+    mesh.texcoords = MemAlloc(sizeof(float) * vertexCount * 2);
+    int at = 0;
+    for(int i = first; i < first + count; i++)
+    {
+        const Mesh *src = &models[keys[i].index]->meshes[0];
+        memcpy(&mesh.vertices[at * 3], src->vertices, sizeof(float) * src->vertexCount * 3);
+        if(src->normals){memcpy(&mesh.normals[at * 3], src->normals, sizeof(float) * src->vertexCount * 3);}
+        if(src->texcoords){memcpy(&mesh.texcoords[at * 2], src->texcoords, sizeof(float) * src->vertexCount * 2);}
+        at += src->vertexCount;
+    }
+    UploadMesh(&mesh, false);
+    b.model = LoadModelFromMesh(mesh);
+    b.model.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = models[keys[first].index]->materials[0].maps[MATERIAL_MAP_DIFFUSE].texture;
+    b.box = GetMeshBoundingBox(mesh);
+    b.textureId = keys[first].textureId;
+    b.objCount = count;
+    b.pvsVisible = true;
+    return b;
+}
+
+//groups non indexed single mesh models by diffuse texture and x/z chunk and merges every group into one model
+//models[i] NULL leaves model i out, outBatch[i] gets the batch model i went into or -1
+//the source models are untouched, collision keeps using them
+StaticBatch *BuildStaticBatches(const Model *const *models, int count, int *outBatch, int *batchCount)
+{
+    *batchCount = 0;
+    BatchKey *keys = MemAlloc(sizeof(BatchKey) * (count > 0 ? count : 1));
+    int keyCount = 0;
+    for(int i = 0; i < count; i++)
+    {
+        outBatch[i] = -1;
+        const Model *m = models[i];
+        if(m == NULL || m->meshCount != 1 || m->meshes[0].indices != NULL || m->meshes[0].vertexCount == 0){continue;}
+        BoundingBox box = GetMeshBoundingBox(m->meshes[0]);
+        Vector3 center = Vector3Scale(Vector3Add(box.min, box.max), 0.5f);
+        keys[keyCount++] = (BatchKey){ m->materials[0].maps[MATERIAL_MAP_DIFFUSE].texture.id,
+            (int)floorf(center.x / STATIC_BATCH_CHUNK_SIZE), (int)floorf(center.z / STATIC_BATCH_CHUNK_SIZE), i };
+    }
+    qsort(keys, keyCount, sizeof(BatchKey), CompareBatchKeys);
+
+    StaticBatch *batches = MemAlloc(sizeof(StaticBatch) * (keyCount > 0 ? keyCount : 1)); //worst case one batch per model
+    int first = 0;
+    while(first < keyCount)
+    {
+        //take the run with the same key, closing it early when it would go past the vertex cap
+        int vertexCount = models[keys[first].index]->meshes[0].vertexCount;
+        int end = first + 1;
+        while(end < keyCount && SameBatch(&keys[first], &keys[end]))
+        {
+            int more = models[keys[end].index]->meshes[0].vertexCount;
+            if(vertexCount + more > STATIC_BATCH_MAX_VERTICES){break;}
+            vertexCount += more;
+            end++;
+        }
+        for(int i = first; i < end; i++){outBatch[keys[i].index] = *batchCount;}
+        batches[(*batchCount)++] = MergeBatch(models, keys, first, end - first, vertexCount);
+        first = end;
+    }
+    MemFree(keys);
+    printf("static batches: %d models merged into %d batches\n", keyCount, *batchCount);
+    return batches;
+}
+
+void UnloadStaticBatches(StaticBatch *batches, int count)
+{
+    //textures belong to the level, UnloadModel leaves them alone
+    for(int i = 0; i < count; i++)
+    {
+        UnloadModel(batches[i].model);
+    }
+    if(batches){MemFree(batches);}
+}
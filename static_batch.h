@@ -0,0 +1,24 @@
+#ifndef STATIC_BATCH_H
+#define STATIC_BATCH_H
+
+#include "raylib.h"
+
+//constants
+#define STATIC_BATCH_CHUNK_SIZE 64.0f //meters, x/z size of the chunks brushes are grouped into for culling, the view distance is 100
+#define STATIC_BATCH_MAX_VERTICES 30000 //a chunk with more than this is split, keeps every upload a sane size
+
+//structs
+//brushes sharing one diffuse texture in one chunk, merged into one mesh and drawn with one call
+typedef struct {
+    Model model;
+    BoundingBox box;
+    unsigned int textureId;
+    int objCount; //brushes merged in
+    bool pvsVisible; //in the potentially visible set of the camera cell
+} StaticBatch;
+
+//functions
+StaticBatch *BuildStaticBatches(const Model *const *models, int count, int *outBatch, int *batchCount);
+void UnloadStaticBatches(StaticBatch *batches, int count);
+
+#endif // STATIC_BATCH_H
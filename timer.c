@@ -2,6 +2,9 @@
 #include "timer.h"
 #include <time.h>
 
+static float gameFrameTime = 0.0f;
+static double gameTime = 0.0;
+
 //timer stuff
 Timer CreateTimer(float dur)
 {
@@ -11,7 +14,7 @@ void StartTimer(Timer *t)
 {
     t->virgin = false;
     t->wasStarted = true;
-    t->start_time = time(NULL); //initial set of start time
+    t->start_time = GetGameSeconds(); //initial set of start time
 }
 bool HasTimerElapsed(Timer *t, time_t cur)
 {
@@ -23,4 +26,24 @@ bool HasTimerElapsed(Timer *t, time_t cur)
 void ResetTimer(Timer *t)
 {
     t->wasStarted =false;
+}
+
+//game clock stuff
+void AdvanceGameClock(float dt)
+{
+    gameFrameTime = dt;
+    gameTime += dt;
+}
+float GetGameFrameTime(void)
+{
+    return gameFrameTime;
+}
+double GetGameTime(void)
+{
+    return gameTime;
+}
+//whole seconds, what the timers count in
+time_t GetGameSeconds(void)
+{
+    return (time_t)gameTime;
 }
\ No newline at end of file
@@ -15,5 +15,10 @@ Timer CreateTimer(float dur);
 void StartTimer(Timer *t);
 bool HasTimerElapsed(Timer *t, time_t cur);
 void ResetTimer(Timer *t);
+//game clock, stepped once a frame, headless runs step it by a fixed amount instead of the wall clock
+void AdvanceGameClock(float dt);
+float GetGameFrameTime(void);
+double GetGameTime(void);
+time_t GetGameSeconds(void);
 
 #endif // FUNCTIONS_H
\ No newline at end of file
@@ -0,0 +1,166 @@
+#include "wireframe.h"
+#include "raylib.h"
+#include "rlgl.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+//qsort has no context pointer, so the vertices for the weld sort live here
+static const float *sortVertices = NULL;
+
+static int CompareVertexPositions(const void *a, const void *b)
+{
+    const float *pa = &sortVertices[*(const int *)a * 3];
+    const float *pb = &sortVertices[*(const int *)b * 3];
+    for(int k = 0; k < 3; k++)
+    {
+        if(pa[k] != pb[k]){return pa[k] < pb[k] ? -1 : 1;}
+    }
+    return *(const int *)a - *(const int *)b;
+}
+
+static int CompareEdgeKeys(const void *a, const void *b)
+{
+    unsigned long long ea = *(const unsigned long long *)a;
+    unsigned long long eb = *(const unsigned long long *)b;
+    return ea < eb ? -1 : (ea > eb ? 1 : 0);
+}
+
+static const void *MeshTopologyKey(const Mesh *mesh)
+{
+    return mesh->indices ? (const void *)mesh->indices : (const void *)mesh->vertices;
+}
+
+//welds vertices at the same position to the lowest index, then keeps every triangle edge once
+static WireEdges BuildWireEdges(const Mesh *mesh)
+{
+    WireEdges e = {0};
+    e.key = MeshTopologyKey(mesh);
+    int vertexCount = mesh->vertexCount;
+    int triCount = mesh->triangleCount;
+    if(vertexCount <= 0 || triCount <= 0 || mesh->vertices == NULL){return e;}
+
+    int *order = MemAlloc(sizeof(int) * vertexCount);
+    int *weld = MemAlloc(sizeof(int) * vertexCount);
+    for(int i = 0; i < vertexCount; i++){order[i] = i;}
+    sortVertices = mesh->vertices;
+    qsort(order, vertexCount, sizeof(int), CompareVertexPositions);
+    for(int i = 0; i < vertexCount; i++)
+    {
+        bool same = i > 0 && memcmp(&mesh->vertices[order[i] * 3], &mesh->vertices[order[i - 1] * 3], sizeof(float) * 3) == 0;
+        weld[order[i]] = same ? weld[order[i - 1]] : order[i];
+    }
+    MemFree(order);
+
+    unsigned long long *keys = MemAlloc(sizeof(unsigned long long) * triCount * 3);
+    int keyCount = 0;
+    for(int t = 0; t < triCount; t++)
+    {
+        for(int k = 0; k < 3; k++)
+        {
+            int a = mesh->indices ? mesh->indices[t * 3 + k] : t * 3 + k;
+            int b = mesh->indices ? mesh->indices[t * 3 + (k + 1) % 3] : t * 3 + (k + 1) % 3;
+            unsigned long long wa = (unsigned int)weld[a];
+            unsigned long long wb = (unsigned int)weld[b];
+            if(wa == wb){continue;}//degenerate
+            keys[keyCount++] = wa < wb ? (wa << 32) | wb : (wb << 32) | wa;
+        }
+    }
+    MemFree(weld);
+    qsort(keys, keyCount, sizeof(unsigned long long), CompareEdgeKeys);
+    e.edges = MemAlloc(sizeof(int) * 2 * (keyCount > 0 ? keyCount : 1));
+    for(int i = 0; i < keyCount; i++)
+    {
+        if(i > 0 && keys[i] == keys[i - 1]){continue;}
+        e.edges[e.edgeCount * 2] = (int)(keys[i] >> 32);
+        e.edges[e.edgeCount * 2 + 1] = (int)(keys[i] & 0xffffffffu);
+        e.edgeCount++;
+    }
+    MemFree(keys);
+    return e;
+}
+
+static unsigned int HashKey(const void *key)
+{
+    uintptr_t k = (uintptr_t)key;
+    k ^= k >> 17;
+    k *= 0x9e3779b1u;
+    return (unsigned int)(k ^ (k >> 15));
+}
+
+static WireEdges *FindSlot(WireEdges *slots, int slotCount, const void *key)
+{
+    unsigned int i = HashKey(key) & (slotCount - 1);
+    while(slots[i].key != NULL && slots[i].key != key){i = (i + 1) & (slotCount - 1);}
+    return &slots[i];
+}
+
+static void GrowWireframeSet(WireframeSet *w)
+{
+    int slotCount = w->slotCount > 0 ? w->slotCount * 2 : WIREFRAME_MIN_TABLE;
+    WireEdges *slots = MemAlloc(sizeof(WireEdges) * slotCount);
+    memset(slots, 0, sizeof(WireEdges) * slotCount);
+    for(int i = 0; i < w->slotCount; i++)
+    {
+        if(w->slots[i].key){*FindSlot(slots, slotCount, w->slots[i].key) = w->slots[i];}
+    }
+    if(w->slots){MemFree(w->slots);}
+    w->slots = slots;
+    w->slotCount = slotCount;
+}
+
+//edges of the mesh, built the first time a topology is seen
+static const WireEdges *GetWireEdges(WireframeSet *w, const Mesh *mesh)
+{
+    const void *key = MeshTopologyKey(mesh);
+    if(key == NULL){return NULL;}
+    if(w->used * 4 >= w->slotCount * 3){GrowWireframeSet(w);}
+    WireEdges *slot = FindSlot(w->slots, w->slotCount, key);
+    if(slot->key == NULL)
+    {
+        *slot = BuildWireEdges(mesh);
+        w->used++;
+    }
+    return slot;
+}
+
+//builds the edge lists up front so turning triangle mode on does not stall
+void AddWireframeModel(WireframeSet *w, Model model)
+{
+    for(int i = 0; i < model.meshCount; i++){GetWireEdges(w, &model.meshes[i]);}
+}
+
+//all edges of the model in one line batch, positions come from the meshes as they are now, so skinned frames draw posed
+void DrawWireframeModel(WireframeSet *w, Model model, Vector3 origin, Color color)
+{
+    rlPushMatrix();
+    rlTranslatef(origin.x, origin.y, origin.z);
+    rlBegin(RL_LINES);
+    rlColor4ub(color.r, color.g, color.b, color.a);
+    for(int i = 0; i < model.meshCount; i++)
+    {
+        const WireEdges *e = GetWireEdges(w, &model.meshes[i]);
+        if(e == NULL){continue;}
+        const float *v = model.meshes[i].vertices;
+        for(int k = 0; k < e->edgeCount * 2; k++)
+        {
+            const float *p = &v[e->edges[k] * 3];
+            rlVertex3f(p[0], p[1], p[2]);
+        }
+    }
+    rlEnd();
+    rlPopMatrix();
+}
+
+void UnloadWireframeSet(WireframeSet *w)
+{
+    int edges = 0;
+    for(int i = 0; i < w->slotCount; i++)
+    {
+        if(w->slots[i].edges){edges += w->slots[i].edgeCount; MemFree(w->slots[i].edges);}
+    }
+    if(w->slots){MemFree(w->slots);}
+    printf("wireframe: %d meshes, %d edges\n", w->used, edges);
+    memset(w, 0, sizeof(WireframeSet));
+}
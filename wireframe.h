@@ -0,0 +1,29 @@
+#ifndef WIREFRAME_H
+#define WIREFRAME_H
+
+#include "raylib.h"
+
+//constants
+#define WIREFRAME_MIN_TABLE 1024 //starting slots of the edge table, it doubles when 3/4 full
+
+//structs
+//unique edges of one mesh topology, vertex index pairs, split vertices welded so a shared edge is drawn once
+typedef struct {
+    const void *key; //the mesh indices, or its vertices when it has none, NULL marks a free slot
+    int *edges;
+    int edgeCount;
+} WireEdges;
+
+//edge lists of every mesh triangle mode draws, skinned copies share the lists of the mesh they came from
+typedef struct {
+    WireEdges *slots;
+    int slotCount; //power of two
+    int used;
+} WireframeSet;
+
+//functions
+void AddWireframeModel(WireframeSet *w, Model model);
+void DrawWireframeModel(WireframeSet *w, Model model, Vector3 origin, Color color);
+void UnloadWireframeSet(WireframeSet *w);
+
+#endif // WIREFRAME_H